@@ -1,5 +1,7 @@
 #include "biginteger.h"
 
+#include <cstring>
+
 bool BigInteger::AbsLess(const BigInteger& b) const {
   if (sign_ == Sign::Zero) {
     if (b.sign_ == Sign::Zero) {
@@ -24,32 +26,30 @@ bool BigInteger::AbsLess(const BigInteger& b) const {
   return false;
 }
 
-bool operator<(const BigInteger& b1, const BigInteger& b2) {
-  if (static_cast<int>(b1.GetSign()) < static_cast<int>(b2.GetSign())) {
-    return true;
+std::strong_ordering operator<=>(const BigInteger& b1, const BigInteger& b2) {
+  if (b1.sign_ != b2.sign_) {
+    return static_cast<int>(b1.sign_) <=> static_cast<int>(b2.sign_);
   }
-  if (static_cast<int>(b1.GetSign()) > static_cast<int>(b2.GetSign())) {
-    return false;
+  if (b1.sign_ == BigInteger::Sign::Zero) {
+    return std::strong_ordering::equal;
   }
-  if (b1.GetSign() == BigInteger::Sign::Minus) {
-    return b2.AbsLess(b1);
+  int abs_order = b1.CompareAbs(b2);
+  if (b1.sign_ == BigInteger::Sign::Minus) {
+    abs_order = -abs_order;
   }
-  return b1.AbsLess(b2);
-}
-bool operator!=(const BigInteger& a, const BigInteger& b) {
-  return (a < b) || (b < a);
+  return abs_order <=> 0;
 }
 bool operator==(const BigInteger& a, const BigInteger& b) {
-  return !(a != b);
-}
-bool operator<=(const BigInteger& a, const BigInteger& b) {
-  return !(b < a);
-}
-bool operator>(const BigInteger& a, const BigInteger& b) {
-  return b < a;
-}
-bool operator>=(const BigInteger& a, const BigInteger& b) {
-  return !(a < b);
+  if (a.sign_ != b.sign_) {
+    return false;
+  }
+  if (a.sign_ == BigInteger::Sign::Zero) {
+    return true;
+  }
+  if (a.integer_.size() != b.integer_.size()) {
+    return false;
+  }
+  return std::memcmp(a.integer_.data(), b.integer_.data(), a.integer_.size() * sizeof(int64_t)) == 0;
 }
 
 void BigInteger::AddZeros(size_t nulls) {
@@ -72,8 +72,9 @@ void BigInteger::DeleteZeros(size_t nulls) {
 
 void BigInteger::Add(const BigInteger& b) {
   int64_t move = 0;
-  std::vector<int64_t> new_int;
+  Limbs new_int;
   size_t n = (integer_.size() > b.integer_.size()) ? integer_.size() : b.integer_.size();
+  new_int.reserve(n + 1);
   for (size_t i = 0; i < n; ++i) {
     if (i < integer_.size()) {
       move += integer_[i];
@@ -92,7 +93,8 @@ void BigInteger::Add(const BigInteger& b) {
 
 void BigInteger::Substract(const BigInteger& b) {
   int64_t move = 0;
-  std::vector<int64_t> new_int;
+  Limbs new_int;
+  new_int.reserve(integer_.size());
   for (size_t i = 0; i < integer_.size(); ++i) {
     if (i < integer_.size()) {
       move += integer_[i];
@@ -113,6 +115,10 @@ void BigInteger::Substract(const BigInteger& b) {
 }
 
 void BigInteger::Divide(BigInteger b, bool div = true) {
+  if (integer_.empty()) {
+    Clear();
+    return;
+  }
   Sign save_sign = sign_;
   if (b.sign_ == Sign::Minus) {
     b.sign_ = Sign::Plus;
@@ -177,20 +183,22 @@ BigInteger::BigInteger(std::string str) : integer_() {
     sign_ = Sign::Zero;
     return;
   }
+  size_t begin = 0;
   if (str[0] == '-') {
     sign_ = Sign::Minus;
-    str.erase(str.begin());
+    begin = 1;
   } else {
     sign_ = Sign::Plus;
   }
-  int idx = static_cast<int>(str.size());
-  while (idx - kBaseSymbols > 0) {
-    integer_.push_back(stoi(str.substr(idx - kBaseSymbols, kBaseSymbols)));
-    idx -= kBaseSymbols;
-  }
-  if (stoi(str.substr(0, idx)) != 0) {
-    integer_.push_back(
-        stoi(str.substr(0, idx)));
+  integer_.reserve((str.size() - begin) / kBaseSymbols + 1);
+  for (size_t end = str.size(); end > begin;) {
+    size_t start = (end - begin > kBaseSymbols) ? end - kBaseSymbols : begin;
+    int64_t limb = 0;
+    for (size_t i = start; i < end; ++i) {
+      limb = limb * 10 + (str[i] - '0');
+    }
+    integer_.push_back(limb);
+    end = start;
   }
   EraseLeadZeros();
 }
@@ -240,9 +248,18 @@ BigInteger::BigInteger(const BigInteger& b) {
   integer_ = b.integer_;
   sign_ = b.sign_;
 }
+BigInteger::BigInteger(BigInteger&& b) noexcept : integer_(std::move(b.integer_)), sign_(b.sign_) {
+  b.Clear();
+}
+BigInteger& BigInteger::operator=(BigInteger&& b) {
+  integer_ = std::move(b.integer_);
+  sign_ = b.sign_;
+  b.Clear();
+  return *this;
+}
 BigInteger::BigInteger(const std::vector<int64_t>& numbers, Sign sign) {
   sign_ = sign;
-  integer_ = numbers;
+  integer_.assign(numbers.begin(), numbers.end());
 }
 BigInteger::operator int() const {
   if (sign_ == Sign::Zero) {
@@ -311,9 +328,7 @@ BigInteger& BigInteger::operator*=(const BigInteger& b) {
   }
   BigInteger multiply = 0;
   size_t size = integer_.size() + b.integer_.size();
-  for (size_t i = 0; i < size + 2; ++i) {
-    multiply.integer_.push_back(0);
-  }
+  multiply.integer_.resize(size + 2, 0);
   for (size_t i = 0; i < integer_.size(); ++i) {
     for (size_t j = 0; j < b.integer_.size(); ++j) {
       multiply.integer_[i + j] += (integer_[i] * b.integer_[j]) % kBase;
@@ -333,6 +348,46 @@ BigInteger& BigInteger::operator*=(const BigInteger& b) {
   EraseLeadZeros();
   return *this;
 }
+void BigInteger::MultiplyAdd(const BigInteger& a, const BigInteger& b, int sign) {
+  int product_sign = static_cast<int>(a.sign_) * static_cast<int>(b.sign_) * sign;
+  if (product_sign == 0) {
+    return;
+  }
+  if (static_cast<int>(sign_) == -product_sign || &a == this || &b == this) {
+    BigInteger product = a * b;
+    if (sign < 0) {
+      *this -= product;
+    } else {
+      *this += product;
+    }
+    return;
+  }
+  size_t size = std::max(integer_.size(), a.integer_.size() + b.integer_.size()) + 1;
+  integer_.resize(size, 0);
+  for (size_t i = 0; i < a.integer_.size(); ++i) {
+    int64_t carry = 0;
+    for (size_t j = 0; j < b.integer_.size(); ++j) {
+      int64_t current = integer_[i + j] + a.integer_[i] * b.integer_[j] + carry;
+      integer_[i + j] = current % kBase;
+      carry = current / kBase;
+    }
+    for (size_t k = i + b.integer_.size(); carry != 0; ++k) {
+      int64_t current = integer_[k] + carry;
+      integer_[k] = current % kBase;
+      carry = current / kBase;
+    }
+  }
+  sign_ = Sign(product_sign);
+  EraseLeadZeros();
+}
+BigInteger& BigInteger::AddProduct(const BigInteger& a, const BigInteger& b) {
+  MultiplyAdd(a, b, 1);
+  return *this;
+}
+BigInteger& BigInteger::SubProduct(const BigInteger& a, const BigInteger& b) {
+  MultiplyAdd(a, b, -1);
+  return *this;
+}
 BigInteger& BigInteger::operator/=(const BigInteger& b) {
   sign_ = Sign(static_cast<int>(sign_) * static_cast<int>(b.sign_));
   Divide(b, true);
@@ -396,16 +451,95 @@ std::string BigInteger::toString() const {
   }
   return res;
 }
+double BigInteger::LeadingLimbs(size_t& shift) const {
+  size_t used = std::min<size_t>(integer_.size(), 3);
+  shift = integer_.size() - used;
+  double value = 0;
+  for (size_t i = integer_.size(); i > shift; --i) {
+    value = value * static_cast<double>(kBase) + static_cast<double>(integer_[i - 1]);
+  }
+  return value;
+}
+size_t BigInteger::Hash() const {
+  uint64_t hash = static_cast<uint64_t>(static_cast<int>(sign_) + 1);
+  if (sign_ == Sign::Zero) {
+    return hash;
+  }
+  for (int64_t limb : integer_) {
+    hash = (hash ^ static_cast<uint64_t>(limb)) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 32;
+  }
+  return static_cast<size_t>(hash);
+}
 std::ostream& operator<<(std::ostream& out, const BigInteger& b) {
   out << b.toString();
   return out;
 }
 std::istream& operator>>(std::istream& in, BigInteger& b) {
-  std::string s;
-  in >> s;
-  b = BigInteger(s);
+  using Traits = std::istream::traits_type;
+  std::istream::sentry sentry(in);
+  if (!sentry) {
+    return in;
+  }
+  std::streambuf* buffer = in.rdbuf();
+  Traits::int_type symbol = buffer->sgetc();
+  BigInteger::Sign sign = BigInteger::Sign::Plus;
+  if (symbol == Traits::to_int_type('-') || symbol == Traits::to_int_type('+')) {
+    if (symbol == Traits::to_int_type('-')) {
+      sign = BigInteger::Sign::Minus;
+    }
+    symbol = buffer->snextc();
+  }
+  // Digits are packed into 9-digit groups as they arrive, most significant first;
+  // only the last group may be short, and it is shifted in after the fact.
+  b.integer_.clear();
+  int64_t group = 0;
+  int64_t scale = 1;
+  bool has_digits = false;
+  while (!Traits::eq_int_type(symbol, Traits::eof())
+      && '0' <= Traits::to_char_type(symbol) && Traits::to_char_type(symbol) <= '9') {
+    group = group * 10 + (Traits::to_char_type(symbol) - '0');
+    scale *= 10;
+    has_digits = true;
+    if (scale == BigInteger::kBase) {
+      b.integer_.push_back(group);
+      group = 0;
+      scale = 1;
+    }
+    symbol = buffer->snextc();
+  }
+  if (Traits::eq_int_type(symbol, Traits::eof())) {
+    in.setstate(std::ios_base::eofbit);
+  }
+  if (!has_digits) {
+    b.Clear();
+    in.setstate(std::ios_base::failbit);
+    return in;
+  }
+  std::reverse(b.integer_.begin(), b.integer_.end());
+  if (scale != 1) {
+    for (int64_t& limb : b.integer_) {
+      int64_t current = limb * scale + group;
+      limb = current % BigInteger::kBase;
+      group = current / BigInteger::kBase;
+    }
+    b.integer_.push_back(group);
+  }
+  b.sign_ = sign;
+  b.EraseLeadZeros();
   return in;
 }
+std::vector<BigInteger> ReadBigIntegers(std::istream& in) {
+  std::vector<BigInteger> numbers;
+  while (true) {
+    numbers.emplace_back();
+    if (!(in >> numbers.back())) {
+      numbers.pop_back();
+      break;
+    }
+  }
+  return numbers;
+}
 BigInteger operator ""_bi(unsigned long long number) {
   return {number, true};
 }
@@ -2,12 +2,21 @@
 #define BIGINTEGER_H_
 
 #include <algorithm>
+#include <compare>
+#include <functional>
 #include <iostream>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "limb_allocator.h"
+
 class BigInteger {
   friend std::ostream& operator<<(std::ostream&, const BigInteger&);
+  friend std::istream& operator>>(std::istream&, BigInteger&);
+  friend void add_n(std::span<BigInteger>, std::span<const BigInteger>);
+  friend void mul_scalar_n(std::span<BigInteger>, const BigInteger&);
+  friend void compare_n(std::span<const BigInteger>, std::span<const BigInteger>, std::span<int>);
  public:
   enum class Sign {
     Minus = -1,
@@ -25,6 +34,7 @@ class BigInteger {
   BigInteger(size_t, bool);
   BigInteger(size_t, char);
   BigInteger(const BigInteger&);
+  BigInteger(BigInteger&&) noexcept;
   BigInteger(const std::vector<int64_t>&, Sign);
 
   explicit operator int() const;
@@ -34,18 +44,28 @@ class BigInteger {
   BigInteger operator-() const;
 
   BigInteger& operator=(const BigInteger&) = default;
-  friend bool operator<(const BigInteger&, const BigInteger&);
+  // Not noexcept: the target keeps its own arena, so limbs from another one are copied.
+  BigInteger& operator=(BigInteger&&);
+  friend std::strong_ordering operator<=>(const BigInteger&, const BigInteger&);
+  friend bool operator==(const BigInteger&, const BigInteger&);
 
   BigInteger& operator+=(const BigInteger&);
   BigInteger& operator-=(const BigInteger&);
   BigInteger& operator*=(const BigInteger&);
   BigInteger& operator/=(const BigInteger&);
   BigInteger& operator%=(const BigInteger&);
+  // Fused *this += a * b and *this -= a * b: the product is accumulated straight
+  // into the limbs when the signs agree, without building a temporary.
+  BigInteger& AddProduct(const BigInteger& a, const BigInteger& b);
+  BigInteger& SubProduct(const BigInteger& a, const BigInteger& b);
   BigInteger& operator++();
   BigInteger operator++(int);
   BigInteger operator--(int);
   BigInteger& operator--();
   std::string toString() const;
+  size_t Hash() const;
+  // Top (at most three) limbs of |*this| as a double; |*this| ~ result * kBase^shift.
+  double LeadingLimbs(size_t& shift) const;
   void Abs();
   void AddZeros(size_t);
   void DeleteZeros(size_t);
@@ -53,15 +73,19 @@ class BigInteger {
   static int GetBaseSymbols() { return kBaseSymbols; }
   static int64_t GetBase() { return kBase; }
  private:
+  using Limbs = std::vector<int64_t, LimbAllocator<int64_t>>;
+
   bool AbsLess(const BigInteger&) const;
+  int CompareAbs(const BigInteger&) const;
   void Clear();
   void Substract(const BigInteger&);
   void Add(const BigInteger&);
   void EraseLeadZeros();
   void Divide(BigInteger, bool);
+  void MultiplyAdd(const BigInteger&, const BigInteger&, int);
   static constexpr int64_t kBase = 1e9;
   static constexpr int kBaseSymbols = 9;
-  std::vector<int64_t> integer_;
+  Limbs integer_;
   Sign sign_;
 };
 
@@ -71,15 +95,29 @@ BigInteger operator/(BigInteger, const BigInteger&);
 BigInteger operator-(BigInteger, const BigInteger&);
 BigInteger operator%(BigInteger, const BigInteger&);
 
-bool operator!=(const BigInteger&, const BigInteger&);
+// Element-wise operations over spans of equal length, vectorized with AVX2
+// when the CPU supports it: dst[i] += src[i], dst[i] *= scalar and
+// result[i] = -1, 0 or 1 as lhs[i] is less, equal or greater than rhs[i].
+// Spans of different length throw std::invalid_argument; scalar may be in dst.
+void add_n(std::span<BigInteger> dst, std::span<const BigInteger> src);
+void mul_scalar_n(std::span<BigInteger> dst, const BigInteger& scalar);
+void compare_n(std::span<const BigInteger> lhs, std::span<const BigInteger> rhs, std::span<int> result);
+
 bool operator==(const BigInteger&, const BigInteger&);
-bool operator>(const BigInteger&, const BigInteger&);
-bool operator<=(const BigInteger&, const BigInteger&);
-bool operator>=(const BigInteger&, const BigInteger&);
+std::strong_ordering operator<=>(const BigInteger&, const BigInteger&);
 
 BigInteger operator ""_bi(unsigned long long);
 BigInteger operator ""_bi(const char*);
 
 std::istream& operator>>(std::istream&, BigInteger&);
+// Reads whitespace-separated numbers until the stream ends or fails.
+std::vector<BigInteger> ReadBigIntegers(std::istream&);
+
+template <>
+struct std::hash<BigInteger> {
+  size_t operator()(const BigInteger& b) const {
+    return b.Hash();
+  }
+};
 
 #endif //BIGINTEGER_H_
@@ -0,0 +1,323 @@
+#include "biginteger.h"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIGINTEGER_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int64_t kBase = 1'000'000'000;
+
+////////////////////////////////Portable kernels////////////////////////////////////
+
+// Brings lanes from [0, 2 * kBase) (or (-kBase, kBase) for Borrow) back into
+// [0, kBase), rippling carries upwards. Returns the carry out of the top lane.
+template <bool Borrow>
+int64_t ResolvePortable(int64_t* lanes, size_t count, int64_t carry = 0) {
+  for (size_t i = 0; i < count; ++i) {
+    if (Borrow) {
+      lanes[i] -= carry;
+      carry = (lanes[i] < 0) ? 1 : 0;
+      lanes[i] += carry * kBase;
+    } else {
+      lanes[i] += carry;
+      carry = (lanes[i] >= kBase) ? 1 : 0;
+      lanes[i] -= carry * kBase;
+    }
+  }
+  return carry;
+}
+
+int ComparePortable(const int64_t* a, const int64_t* b, size_t count) {
+  for (size_t i = count; i > 0; --i) {
+    if (a[i - 1] != b[i - 1]) {
+      return (a[i - 1] < b[i - 1]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+void LaneAddPortable(int64_t* dst, const int64_t* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] += src[i];
+  }
+}
+
+void LaneSubPortable(int64_t* dst, const int64_t* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] -= src[i];
+  }
+}
+
+void LaneRevSubPortable(int64_t* dst, const int64_t* src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = src[i] - dst[i];
+  }
+}
+
+void LaneMulPortable(int64_t* dst, int64_t scalar, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] *= scalar;
+  }
+}
+
+////////////////////////////////AVX2 kernels////////////////////////////////////////
+
+#ifdef BIGINTEGER_AVX2_KERNELS
+
+bool HasAvx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+__attribute__((target("avx2"))) __m256i ExpandBits(uint64_t bits) {
+  const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+  __m256i spread = _mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>(bits & 15)), select);
+  return _mm256_cmpeq_epi64(spread, select);
+}
+
+// Carry-lookahead over 64 lanes at a time: "generate" lanes overflow on their own,
+// "propagate" lanes overflow only if a carry comes in, so adding the propagate mask
+// to the shifted generate mask ripples every carry in a single integer addition.
+template <bool Borrow>
+__attribute__((target("avx2"))) int64_t ResolveAvx2(int64_t* lanes, size_t count) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i top = _mm256_set1_epi64x(kBase - 1);
+  const __m256i base = _mm256_set1_epi64x(kBase);
+  uint64_t carry = 0;
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t generate = 0;
+    uint64_t propagate = 0;
+    for (size_t k = 0; k < 16; ++k) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes + i + 4 * k));
+      __m256i g = Borrow ? _mm256_cmpgt_epi64(zero, v) : _mm256_cmpgt_epi64(v, top);
+      __m256i p = _mm256_cmpeq_epi64(v, Borrow ? zero : top);
+      generate |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(g))) << (4 * k);
+      propagate |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(p))) << (4 * k);
+    }
+    uint64_t carry_in = (((generate << 1) | carry) + propagate) ^ propagate;
+    uint64_t carry_out = generate | (propagate & carry_in);
+    for (size_t k = 0; k < 16; ++k) {
+      auto* ptr = reinterpret_cast<__m256i*>(lanes + i + 4 * k);
+      __m256i v = _mm256_loadu_si256(ptr);
+      __m256i in = ExpandBits(carry_in >> (4 * k));
+      __m256i out = _mm256_and_si256(ExpandBits(carry_out >> (4 * k)), base);
+      if (Borrow) {
+        v = _mm256_add_epi64(_mm256_add_epi64(v, in), out);
+      } else {
+        v = _mm256_sub_epi64(_mm256_sub_epi64(v, in), out);
+      }
+      _mm256_storeu_si256(ptr, v);
+    }
+    carry = carry_out >> 63;
+  }
+  return ResolvePortable<Borrow>(lanes + i, count - i, static_cast<int64_t>(carry));
+}
+
+__attribute__((target("avx2"))) int CompareAvx2(const int64_t* a, const int64_t* b, size_t count) {
+  size_t i = count;
+  for (; i % 4 != 0; --i) {
+    if (a[i - 1] != b[i - 1]) {
+      return (a[i - 1] < b[i - 1]) ? -1 : 1;
+    }
+  }
+  for (; i > 0; i -= 4) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 4));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i - 4));
+    int equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(va, vb)));
+    if (equal != 15) {
+      size_t lane = 31 - __builtin_clz(static_cast<unsigned>(~equal & 15));
+      return (a[i - 4 + lane] < b[i - 4 + lane]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+template <int Op>
+__attribute__((target("avx2"))) void LaneOpAvx2(int64_t* dst, const int64_t* src, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m256i*>(dst + i);
+    __m256i d = _mm256_loadu_si256(ptr);
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    if (Op == 0) {
+      d = _mm256_add_epi64(d, s);
+    } else if (Op == 1) {
+      d = _mm256_sub_epi64(d, s);
+    } else {
+      d = _mm256_sub_epi64(s, d);
+    }
+    _mm256_storeu_si256(ptr, d);
+  }
+  if (Op == 0) {
+    LaneAddPortable(dst + i, src + i, count - i);
+  } else if (Op == 1) {
+    LaneSubPortable(dst + i, src + i, count - i);
+  } else {
+    LaneRevSubPortable(dst + i, src + i, count - i);
+  }
+}
+
+// Limbs and the scalar are below 2^32, so the 32x32->64 multiply is exact.
+__attribute__((target("avx2"))) void LaneMulAvx2(int64_t* dst, int64_t scalar, size_t count) {
+  const __m256i s = _mm256_set1_epi64x(scalar);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m256i*>(dst + i);
+    _mm256_storeu_si256(ptr, _mm256_mul_epu32(_mm256_loadu_si256(ptr), s));
+  }
+  LaneMulPortable(dst + i, scalar, count - i);
+}
+
+#endif
+
+////////////////////////////////Dispatch////////////////////////////////////////////
+
+template <bool Borrow>
+int64_t Resolve(int64_t* lanes, size_t count) {
+#ifdef BIGINTEGER_AVX2_KERNELS
+  if (HasAvx2()) {
+    return ResolveAvx2<Borrow>(lanes, count);
+  }
+#endif
+  return ResolvePortable<Borrow>(lanes, count);
+}
+
+int CompareLimbs(const int64_t* a, const int64_t* b, size_t count) {
+#ifdef BIGINTEGER_AVX2_KERNELS
+  if (HasAvx2()) {
+    return CompareAvx2(a, b, count);
+  }
+#endif
+  return ComparePortable(a, b, count);
+}
+
+template <int Op>
+void LaneOp(int64_t* dst, const int64_t* src, size_t count) {
+#ifdef BIGINTEGER_AVX2_KERNELS
+  if (HasAvx2()) {
+    LaneOpAvx2<Op>(dst, src, count);
+    return;
+  }
+#endif
+  if (Op == 0) {
+    LaneAddPortable(dst, src, count);
+  } else if (Op == 1) {
+    LaneSubPortable(dst, src, count);
+  } else {
+    LaneRevSubPortable(dst, src, count);
+  }
+}
+
+void LaneMul(int64_t* dst, int64_t scalar, size_t count) {
+#ifdef BIGINTEGER_AVX2_KERNELS
+  if (HasAvx2()) {
+    LaneMulAvx2(dst, scalar, count);
+    return;
+  }
+#endif
+  LaneMulPortable(dst, scalar, count);
+}
+
+}
+
+////////////////////////////////Batch operations////////////////////////////////////
+
+int BigInteger::CompareAbs(const BigInteger& b) const {
+  if (integer_.size() != b.integer_.size()) {
+    return (integer_.size() < b.integer_.size()) ? -1 : 1;
+  }
+  return CompareLimbs(integer_.data(), b.integer_.data(), integer_.size());
+}
+
+void add_n(std::span<BigInteger> dst, std::span<const BigInteger> src) {
+  if (dst.size() != src.size()) {
+    throw std::invalid_argument("add_n: spans differ in length");
+  }
+  for (size_t i = 0; i < dst.size(); ++i) {
+    BigInteger& a = dst[i];
+    const BigInteger& b = src[i];
+    if (b.sign_ == BigInteger::Sign::Zero) {
+      continue;
+    }
+    if (a.sign_ == BigInteger::Sign::Zero) {
+      a = b;
+      continue;
+    }
+    if (a.sign_ == b.sign_) {
+      if (a.integer_.size() < b.integer_.size()) {
+        a.integer_.resize(b.integer_.size(), 0);
+      }
+      LaneOp<0>(a.integer_.data(), b.integer_.data(), b.integer_.size());
+      if (Resolve<false>(a.integer_.data(), a.integer_.size()) != 0) {
+        a.integer_.push_back(1);
+      }
+      continue;
+    }
+    if (a.CompareAbs(b) >= 0) {
+      LaneOp<1>(a.integer_.data(), b.integer_.data(), b.integer_.size());
+    } else {
+      a.integer_.resize(b.integer_.size(), 0);
+      LaneOp<2>(a.integer_.data(), b.integer_.data(), b.integer_.size());
+      a.sign_ = b.sign_;
+    }
+    Resolve<true>(a.integer_.data(), a.integer_.size());
+    a.EraseLeadZeros();
+  }
+}
+
+void mul_scalar_n(std::span<BigInteger> dst, const BigInteger& scalar) {
+  if (scalar.sign_ == BigInteger::Sign::Zero) {
+    for (BigInteger& a : dst) {
+      a.Clear();
+    }
+    return;
+  }
+  // scalar may be an element of dst, so it is read in full before anything is written.
+  if (scalar.integer_.size() > 1) {
+    const BigInteger factor = scalar;
+    for (BigInteger& a : dst) {
+      a *= factor;
+    }
+    return;
+  }
+  const int64_t factor = scalar.integer_[0];
+  const int factor_sign = static_cast<int>(scalar.sign_);
+  BigInteger::Limbs high;
+  for (BigInteger& a : dst) {
+    if (a.sign_ == BigInteger::Sign::Zero) {
+      continue;
+    }
+    a.sign_ = BigInteger::Sign(static_cast<int>(a.sign_) * factor_sign);
+    size_t size = a.integer_.size();
+    LaneMul(a.integer_.data(), factor, size);
+    high.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      high[i] = a.integer_[i] / kBase;
+      a.integer_[i] %= kBase;
+    }
+    a.integer_.push_back(0);
+    LaneOp<0>(a.integer_.data() + 1, high.data(), size);
+    Resolve<false>(a.integer_.data(), a.integer_.size());
+    a.EraseLeadZeros();
+  }
+}
+
+void compare_n(std::span<const BigInteger> lhs, std::span<const BigInteger> rhs, std::span<int> result) {
+  if (rhs.size() != lhs.size() || result.size() != lhs.size()) {
+    throw std::invalid_argument("compare_n: spans differ in length");
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    int sign = static_cast<int>(lhs[i].sign_);
+    int other_sign = static_cast<int>(rhs[i].sign_);
+    if (sign != other_sign) {
+      result[i] = (sign < other_sign) ? -1 : 1;
+    } else {
+      result[i] = sign * lhs[i].CompareAbs(rhs[i]);
+    }
+  }
+}
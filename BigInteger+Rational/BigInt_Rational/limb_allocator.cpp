@@ -0,0 +1,27 @@
+#include "limb_allocator.h"
+
+namespace {
+thread_local std::pmr::memory_resource* current_resource = nullptr;
+}
+
+std::pmr::memory_resource* CurrentLimbResource() {
+  return current_resource;
+}
+
+std::pmr::memory_resource* LimbArena::Enter(std::pmr::memory_resource* resource) {
+  std::pmr::memory_resource* previous = current_resource;
+  current_resource = resource;
+  return previous;
+}
+
+LimbArena::LimbArena()
+    : resource_(std::make_unique<std::pmr::monotonic_buffer_resource>()),
+      previous_(Enter(resource_.get())) {}
+
+LimbArena::LimbArena(size_t initial_size)
+    : resource_(std::make_unique<std::pmr::monotonic_buffer_resource>(initial_size)),
+      previous_(Enter(resource_.get())) {}
+
+LimbArena::~LimbArena() {
+  current_resource = previous_;
+}
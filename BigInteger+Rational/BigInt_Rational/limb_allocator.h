@@ -0,0 +1,112 @@
+#ifndef LIMB_ALLOCATOR_H_
+#define LIMB_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+// Resource of the innermost LimbArena on this thread, nullptr for the global heap.
+std::pmr::memory_resource* CurrentLimbResource();
+
+// Allocator of BigInteger limbs: binds to the current resource when created,
+// so every temporary made inside a LimbArena scope lands in that arena.
+template <typename T>
+class LimbAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_swap = std::true_type;
+
+  LimbAllocator() : resource_(CurrentLimbResource()) {}
+  template <typename U>
+  LimbAllocator(const LimbAllocator<U>& alloc) : resource_(alloc.GetResource()) {}
+
+  T* allocate(size_t count) {
+    if (resource_ == nullptr) {
+      return std::allocator<T>().allocate(count);
+    }
+    return static_cast<T*>(resource_->allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t count) {
+    if (resource_ == nullptr) {
+      std::allocator<T>().deallocate(ptr, count);
+      return;
+    }
+    resource_->deallocate(ptr, count * sizeof(T), alignof(T));
+  }
+
+  LimbAllocator select_on_container_copy_construction() const {
+    return LimbAllocator();
+  }
+
+  std::pmr::memory_resource* GetResource() const {
+    return resource_;
+  }
+
+  template <typename U>
+  bool operator==(const LimbAllocator<U>& alloc) const {
+    if (resource_ == nullptr || alloc.GetResource() == nullptr) {
+      return resource_ == alloc.GetResource();
+    }
+    return resource_->is_equal(*alloc.GetResource());
+  }
+  template <typename U>
+  bool operator!=(const LimbAllocator<U>& alloc) const {
+    return !(*this == alloc);
+  }
+
+ private:
+  std::pmr::memory_resource* resource_;
+};
+
+// Adapts any standard allocator (e.g. StackAllocator) to a memory resource.
+template <typename Alloc>
+class AllocatorResource : public std::pmr::memory_resource {
+  using Block = std::max_align_t;
+  using Traits = typename std::allocator_traits<Alloc>::template rebind_traits<Block>;
+
+ public:
+  explicit AllocatorResource(const Alloc& alloc) : alloc_(alloc) {}
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    if (alignment > alignof(Block)) {
+      throw std::bad_alloc();
+    }
+    return Traits::allocate(alloc_, Blocks(bytes));
+  }
+  void do_deallocate(void* ptr, size_t bytes, size_t) override {
+    Traits::deallocate(alloc_, static_cast<Block*>(ptr), Blocks(bytes));
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+  static size_t Blocks(size_t bytes) {
+    return (bytes + sizeof(Block) - 1) / sizeof(Block);
+  }
+
+  typename Traits::allocator_type alloc_;
+};
+
+// Scope in which all new BigInteger limbs are bump-allocated and released at once
+// on destruction. Numbers created inside must not outlive it: copy results out.
+class LimbArena {
+ public:
+  LimbArena();
+  explicit LimbArena(size_t initial_size);
+  template <typename Alloc, typename = typename Alloc::value_type>
+  explicit LimbArena(const Alloc& alloc)
+      : resource_(std::make_unique<AllocatorResource<Alloc>>(alloc)),
+        previous_(Enter(resource_.get())) {}
+
+  LimbArena(const LimbArena&) = delete;
+  LimbArena& operator=(const LimbArena&) = delete;
+  ~LimbArena();
+
+ private:
+  static std::pmr::memory_resource* Enter(std::pmr::memory_resource*);
+  std::unique_ptr<std::pmr::memory_resource> resource_;
+  std::pmr::memory_resource* previous_;
+};
+
+#endif //LIMB_ALLOCATOR_H_
@@ -1,34 +1,32 @@
 #include "rational.h"
 
-bool operator<(const Rational& a, const Rational& b) {
-  if (static_cast<int>(a.sign_) < static_cast<int>(b.sign_)) {
-    return true;
-  }
-  if (static_cast<int>(a.sign_) > static_cast<int>(b.sign_)) {
-    return false;
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+std::strong_ordering operator<=>(const Rational& a, const Rational& b) {
+  if (a.sign_ != b.sign_) {
+    return static_cast<int>(a.sign_) <=> static_cast<int>(b.sign_);
   }
   if (a.sign_ == BigInteger::Sign::Zero) {
-    return (static_cast<int>(b.sign_) > 0);
+    return std::strong_ordering::equal;
+  }
+  if (a.upper_ < b.lower_) {
+    return std::strong_ordering::less;
+  }
+  if (a.lower_ > b.upper_) {
+    return std::strong_ordering::greater;
   }
+  std::strong_ordering abs_order = (a.denominator_ == b.denominator_)
+      ? a.numerator_ <=> b.numerator_
+      : a.numerator_ * b.denominator_ <=> b.numerator_ * a.denominator_;
   if (a.sign_ == BigInteger::Sign::Minus) {
-    return a.numerator_ * b.denominator_ > b.numerator_ * a.denominator_;
+    return 0 <=> abs_order;
   }
-  return a.numerator_ * b.denominator_ < b.numerator_ * a.denominator_;
-}
-bool operator>(const Rational& a, const Rational& b) {
-  return b < a;
-}
-bool operator<=(const Rational& a, const Rational& b) {
-  return !(a > b);
-}
-bool operator>=(const Rational& a, const Rational& b) {
-  return !(a < b);
-}
-bool operator!=(const Rational& a, const Rational& b) {
-  return a < b || b < a;
+  return abs_order;
 }
 bool operator==(const Rational& a, const Rational& b) {
-  return !(a != b);
+  return a.sign_ == b.sign_ && a.numerator_ == b.numerator_ && a.denominator_ == b.denominator_;
 }
 Rational::Rational(int64_t n) : numerator_(n), denominator_(1) {
   MakeSimple(true);
@@ -47,6 +45,8 @@ Rational::Rational(const Rational& r) {
   numerator_ = r.numerator_;
   denominator_ = r.denominator_;
   sign_ = r.sign_;
+  lower_ = r.lower_;
+  upper_ = r.upper_;
 }
 
 Rational::operator double() {
@@ -56,6 +56,9 @@ Rational::operator double() {
 
 Rational& Rational::operator-() {
   sign_ = Sign(static_cast<int>(sign_) * -1);
+  std::swap(lower_, upper_);
+  lower_ = -lower_;
+  upper_ = -upper_;
   return *this;
 }
 
@@ -138,6 +141,147 @@ std::string Rational::asDecimal(std::size_t precision) {
   return s;
 }
 
+size_t Rational::Hash() const {
+  size_t hash = numerator_.Hash() * 31 + static_cast<size_t>(static_cast<int>(sign_) + 1);
+  hash ^= denominator_.Hash() + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+Rational Rational::abs() const {
+  Rational result = *this;
+  if (result.sign_ == Sign::Minus) {
+    -result;
+  }
+  return result;
+}
+
+BigInteger Rational::ContinuedFraction::Next() {
+  BigInteger term = numerator_ / denominator_;
+  BigInteger rest = numerator_ - term * denominator_;
+  if (rest.GetSign() == Sign::Minus) {
+    --term;
+    rest += denominator_;
+  }
+  numerator_ = denominator_;
+  denominator_ = rest;
+  return term;
+}
+
+Rational::ContinuedFraction Rational::continuedFraction() const {
+  return {static_cast<int>(sign_) * numerator_, denominator_};
+}
+
+Rational Rational::limitDenominator(const BigInteger& max_denominator) const {
+  if (max_denominator < 1) {
+    throw std::invalid_argument("Rational::limitDenominator: max_denominator must be at least 1");
+  }
+  if (denominator_ <= max_denominator) {
+    return *this;
+  }
+  // Convergents p1/q1 and the one before it, walked until the next denominator
+  // would exceed the limit; the best answer is p1/q1 or the largest semiconvergent.
+  BigInteger p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+  ContinuedFraction terms(numerator_, denominator_);
+  while (terms.HasNext()) {
+    BigInteger term = terms.Next();
+    BigInteger q2 = q0 + term * q1;
+    if (q2 > max_denominator) {
+      break;
+    }
+    BigInteger p2 = p0 + term * p1;
+    p0 = p1, q0 = q1;
+    p1 = p2, q1 = q2;
+  }
+  BigInteger k = (max_denominator - q0) / q1;
+  Rational semiconvergent(p0 + k * p1, q0 + k * q1);
+  Rational convergent(p1, q1);
+  Rational value = abs();
+  Rational result = ((convergent - value).abs() <= (semiconvergent - value).abs()) ? convergent : semiconvergent;
+  if (sign_ == Sign::Minus) {
+    -result;
+  }
+  return result;
+}
+
+Rational Rational::fromDouble(double value, const BigInteger& max_denominator) {
+  if (!std::isfinite(value)) {
+    throw std::invalid_argument("Rational::fromDouble: value is not finite");
+  }
+  int exponent = 0;
+  double fraction = std::frexp(std::fabs(value), &exponent);
+  auto mantissa = static_cast<int64_t>(std::ldexp(fraction, 53));
+  exponent -= 53;
+  while (mantissa != 0 && mantissa % 2 == 0 && exponent < 0) {
+    mantissa /= 2;
+    ++exponent;
+  }
+  BigInteger power = 1;
+  for (int bits = std::abs(exponent); bits > 0; bits -= 30) {
+    power *= static_cast<int64_t>(1) << std::min(bits, 30);
+  }
+  BigInteger numerator = (value < 0) ? -mantissa : mantissa;
+  Rational exact = (exponent >= 0) ? Rational(numerator * power) : Rational(numerator, power);
+  return exact.limitDenominator(max_denominator);
+}
+
+void Rational::Accumulate(BigInteger& numerator, BigInteger& denominator, const BigInteger& a,
+                          const BigInteger& b, int sign, const BigInteger& term_denominator) {
+  if (term_denominator == denominator) {
+    if (sign > 0) {
+      numerator.AddProduct(a, b);
+    } else {
+      numerator.SubProduct(a, b);
+    }
+    return;
+  }
+  BigInteger common = GCD(denominator, term_denominator);
+  BigInteger scale = term_denominator / common;
+  if (scale != 1) {
+    numerator *= scale;
+    denominator *= scale;
+  }
+  BigInteger term_scale = denominator / term_denominator;
+  BigInteger scaled = (term_scale == 1) ? a : a * term_scale;
+  if (sign > 0) {
+    numerator.AddProduct(scaled, b);
+  } else {
+    numerator.SubProduct(scaled, b);
+  }
+}
+
+Rational Rational::dot(std::span<const Rational> x, std::span<const Rational> y) {
+  if (x.size() != y.size()) {
+    throw std::invalid_argument("Rational::dot: spans differ in length");
+  }
+  BigInteger numerator = 0;
+  BigInteger denominator = 1;
+  for (size_t i = 0; i < x.size(); ++i) {
+    int sign = static_cast<int>(x[i].sign_) * static_cast<int>(y[i].sign_);
+    if (sign == 0) {
+      continue;
+    }
+    BigInteger term_denominator = x[i].denominator_;
+    if (y[i].denominator_ != 1) {
+      term_denominator *= y[i].denominator_;
+    }
+    Accumulate(numerator, denominator, x[i].numerator_, y[i].numerator_, sign, term_denominator);
+  }
+  return {numerator, denominator};
+}
+
+Rational Rational::sum(std::span<const Rational> x) {
+  BigInteger numerator = 0;
+  BigInteger denominator = 1;
+  const BigInteger one = 1;
+  for (const Rational& r : x) {
+    if (r.sign_ == Sign::Zero) {
+      continue;
+    }
+    Accumulate(numerator, denominator, r.numerator_, one, static_cast<int>(r.sign_), r.denominator_);
+  }
+  return {numerator, denominator};
+}
+
 BigInteger Rational::GCD(BigInteger b1, BigInteger b2) {
   if (b1 < b2) { std::swap(b2, b1); }
   while(static_cast<bool>(b2)) {
@@ -151,6 +295,7 @@ void Rational::MakeSimple(bool change_sign) {
   if (numerator_.GetSign() == BigInteger::Sign::Zero) {
     sign_ = BigInteger::Sign::Zero;
     denominator_ = 1;
+    UpdateBounds();
     return;
   } else if (change_sign) {
     sign_ = Sign(static_cast<int>(numerator_.GetSign()) * static_cast<int>(denominator_.GetSign()));
@@ -160,4 +305,31 @@ void Rational::MakeSimple(bool change_sign) {
   BigInteger res = GCD(numerator_, denominator_);
   numerator_ /= res;
   denominator_ /= res;
+  UpdateBounds();
+}
+
+// Three leading limbs keep ~2^-53 relative error per operand; 1e-12 leaves ample slack
+// for the division and the power of the base, so the interval always contains the value.
+void Rational::UpdateBounds() {
+  if (sign_ == Sign::Zero) {
+    lower_ = upper_ = 0;
+    return;
+  }
+  size_t num_shift = 0;
+  size_t den_shift = 0;
+  double value = numerator_.LeadingLimbs(num_shift) / denominator_.LeadingLimbs(den_shift);
+  double scale = static_cast<double>(num_shift) - static_cast<double>(den_shift);
+  value *= std::pow(static_cast<double>(BigInteger::GetBase()), scale);
+  if (!std::isnormal(value)) {
+    lower_ = -std::numeric_limits<double>::infinity();
+    upper_ = std::numeric_limits<double>::infinity();
+    return;
+  }
+  lower_ = value * (1 - 1e-12);
+  upper_ = value * (1 + 1e-12);
+  if (sign_ == Sign::Minus) {
+    std::swap(lower_, upper_);
+    lower_ = -lower_;
+    upper_ = -upper_;
+  }
 }
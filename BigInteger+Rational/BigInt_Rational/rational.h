@@ -1,6 +1,9 @@
 #ifndef RATIONAL_H_
 #define RATIONAL_H_
 
+#include <compare>
+#include <span>
+
 #include "biginteger.h"
 
 class Rational {
@@ -8,9 +11,27 @@ class Rational {
   Sign sign_ = Sign::Zero;
   BigInteger numerator_;
   BigInteger denominator_;
+  // Cached enclosure lower_ <= value <= upper_, infinite when doubles cannot hold it.
+  double lower_ = 0;
+  double upper_ = 0;
   void MakeSimple(bool);
+  void UpdateBounds();
   static BigInteger GCD(BigInteger, BigInteger);
+  static void Accumulate(BigInteger&, BigInteger&, const BigInteger&, const BigInteger&, int,
+                         const BigInteger&);
  public:
+  // Lazily yields the terms a0; a1, a2, ... of the regular continued fraction.
+  class ContinuedFraction {
+   public:
+    ContinuedFraction(const BigInteger& numerator, const BigInteger& denominator)
+        : numerator_(numerator), denominator_(denominator) {}
+    bool HasNext() const { return static_cast<bool>(denominator_); }
+    BigInteger Next();
+   private:
+    BigInteger numerator_;
+    BigInteger denominator_;
+  };
+
   Rational(): numerator_(0), denominator_(1) {}
   Rational(int64_t);
   Rational(int64_t, int64_t);
@@ -27,20 +48,39 @@ class Rational {
 
   std::string toString() const;
   std::string asDecimal(std::size_t);
+  size_t Hash() const;
+
+  Rational abs() const;
+  ContinuedFraction continuedFraction() const;
+  // Closest fraction with denominator at most max_denominator; throws
+  // std::invalid_argument when max_denominator < 1.
+  Rational limitDenominator(const BigInteger& max_denominator) const;
+  static Rational fromDouble(double, const BigInteger& max_denominator);
+
+  // Exact sum(x[i] * y[i]) and sum(x[i]): numerators are accumulated over a running
+  // common denominator and the result is reduced only once at the end. dot throws
+  // std::invalid_argument when x and y differ in length.
+  static Rational dot(std::span<const Rational> x, std::span<const Rational> y);
+  static Rational sum(std::span<const Rational> x);
 
   explicit operator double ();
-  friend bool operator<(const Rational &a, const Rational &b);
+  friend std::strong_ordering operator<=>(const Rational&, const Rational&);
+  friend bool operator==(const Rational&, const Rational&);
 };
 
-bool operator>(const Rational&, const Rational&);
-bool operator<=(const Rational&, const Rational&);
-bool operator>=(const Rational&, const Rational&);
-bool operator!=(const Rational&, const Rational&);
 bool operator==(const Rational&, const Rational&);
+std::strong_ordering operator<=>(const Rational&, const Rational&);
 
 Rational operator+(Rational, const Rational&);
 Rational operator-(Rational, const Rational&);
 Rational operator*(Rational, const Rational&);
 Rational operator/(Rational, const Rational&);
 
+template <>
+struct std::hash<Rational> {
+  size_t operator()(const Rational& r) const {
+    return r.Hash();
+  }
+};
+
 #endif //RATIONAL_H_
\ No newline at end of file
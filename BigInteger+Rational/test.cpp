@@ -1,13 +1,17 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "BigInt_Rational/rational.h"
+#include "../SomeOtherTasks/StackAllocator/stackallocator.cpp"
+#include "../UnorderedMap/unordered_map.cpp"
 
 
 void hard_test() {
@@ -228,6 +232,15 @@ void random_test() {
     Rational a(first, second);
     Rational b(third, fourth);
     if (second * fourth != 0) {
+      int64_t lhs = first * fourth;
+      int64_t rhs = third * second;
+      if (second * fourth < 0) {
+        std::swap(lhs, rhs);
+      }
+      assert((a <=> b) == (lhs <=> rhs));
+      assert((a < b) == (lhs < rhs));
+      assert((a >= b) == (lhs >= rhs));
+      assert((a != b) == (lhs != rhs));
       assert((a - b) ==
           Rational(first * fourth - third * second, second * fourth));
       assert(a + b ==
@@ -260,7 +273,279 @@ void long_divide_test() {
   std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " [µs]" << std::endl;
 }
 
+BigInteger factorial(int64_t n) {
+  BigInteger result = 1;
+  for (int64_t i = 2; i <= n; ++i) {
+    result *= i;
+  }
+  return result;
+}
+
+void arena_test() {
+  std::cout << "Biginteger arena test started!" << std::endl;
+  BigInteger expected = factorial(300) / factorial(200);
+
+  BigInteger result;
+  {
+    LimbArena arena(1 << 16);
+    result = factorial(300) / factorial(200);
+  }
+  assert(result == expected);
+
+  const size_t kStorageSize = 1 << 22;
+  // Static: 4 MB is too much for the stack.
+  static StackStorage<kStorageSize> storage;
+  {
+    LimbArena arena{StackAllocator<int64_t, kStorageSize>(storage)};
+    result = factorial(300) / factorial(200);
+    Rational r(factorial(30), factorial(32));
+    assert(r == Rational(1, 992));
+  }
+  assert(result == expected);
+}
+
+void batch_test() {
+  std::cout << "Biginteger batch test started!" << std::endl;
+  std::random_device dev;
+  std::mt19937 rnd(dev());
+  std::uniform_int_distribution<std::mt19937::result_type> digit(0, 9);
+  std::uniform_int_distribution<std::mt19937::result_type> length(1, 1200);
+
+  auto random_number = [&]() {
+    std::string s = (digit(rnd) % 2 == 0) ? "-" : "";
+    size_t len = length(rnd);
+    bool nines = digit(rnd) < 3;
+    for (size_t i = 0; i < len; ++i) {
+      s += static_cast<char>('0' + (nines ? 9 : digit(rnd)));
+    }
+    return BigInteger(s);
+  };
+
+  const size_t count = 200;
+  std::vector<BigInteger> a, b;
+  for (size_t i = 0; i < count; ++i) {
+    a.push_back(random_number());
+    b.push_back(digit(rnd) == 0 ? -a.back() : random_number());
+  }
+  b[0] = 1;
+  a[0] = BigInteger(std::string(700, '9'));
+  a[1] = 0;
+
+  std::vector<int> order(count);
+  compare_n(a, b, order);
+  for (size_t i = 0; i < count; ++i) {
+    assert(order[i] == ((a[i] < b[i]) ? -1 : (b[i] < a[i] ? 1 : 0)));
+  }
+
+  std::vector<BigInteger> sum = a;
+  add_n(sum, b);
+  for (size_t i = 0; i < count; ++i) {
+    assert(sum[i] == a[i] + b[i]);
+  }
+
+  for (BigInteger scalar : {BigInteger(0), BigInteger(-7), BigInteger(999'999'999), b[2]}) {
+    std::vector<BigInteger> product = a;
+    mul_scalar_n(product, scalar);
+    for (size_t i = 0; i < count; ++i) {
+      assert(product[i] == a[i] * scalar);
+    }
+  }
+
+  for (BigInteger scalar : {BigInteger(-7), b[2]}) {
+    std::vector<BigInteger> product = a;
+    product[5] = scalar;
+    mul_scalar_n(product, product[5]);
+    for (size_t i = 0; i < count; ++i) {
+      assert(product[i] == (i == 5 ? scalar : a[i]) * scalar);
+    }
+  }
+
+  size_t thrown = 0;
+  std::span<const BigInteger> shorter = std::span<const BigInteger>(b).first(count - 1);
+  try {
+    add_n(sum, shorter);
+  } catch (const std::invalid_argument&) {
+    ++thrown;
+  }
+  try {
+    compare_n(a, shorter, order);
+  } catch (const std::invalid_argument&) {
+    ++thrown;
+  }
+  try {
+    compare_n(a, b, std::span<int>(order).first(count - 1));
+  } catch (const std::invalid_argument&) {
+    ++thrown;
+  }
+  assert(thrown == 3);
+}
+
+void hash_test() {
+  std::cout << "Biginteger hash test started!" << std::endl;
+  BigInteger zero;
+  BigInteger other_zero(static_cast<size_t>(0), true);
+  assert(zero == other_zero);
+  assert(std::hash<BigInteger>()(zero) == std::hash<BigInteger>()(other_zero));
+  assert(BigInteger(-5) != BigInteger(5));
+  assert(BigInteger("123456789123456789") == 123456789123456789);
+
+  std::unordered_set<BigInteger> integers;
+  for (int64_t i = -1000; i < 1000; ++i) {
+    integers.insert(BigInteger(i) * 1'000'000'007);
+  }
+  assert(integers.size() == 2000);
+  assert(integers.count(BigInteger(-999) * 1'000'000'007) == 1);
+  assert(integers.count(BigInteger(1'000'000'007)) == 1);
+  assert(integers.count(BigInteger(1'000'000'008)) == 0);
+
+  UnorderedMap<Rational, int> rationals;
+  for (int64_t i = 1; i <= 100; ++i) {
+    rationals[Rational(i, 100)] += 1;
+    rationals[Rational(2 * i, 200)] += 1;
+  }
+  assert(rationals.size() == 100);
+  assert(rationals.at(Rational(1, 2)) == 2);
+  assert(rationals.find(Rational(-1, 2)) == rationals.end());
+  assert(std::hash<Rational>()(Rational(3, 6)) == std::hash<Rational>()(Rational(-7, -14)));
+}
+
+void stream_test() {
+  std::cout << "Biginteger stream test started!" << std::endl;
+  std::string digits;
+  for (size_t i = 0; i < 100'000; ++i) {
+    digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+  }
+  for (size_t length : {1, 8, 9, 10, 17, 18, 19, 1000, 100'000}) {
+    std::string number = digits.substr(digits.size() - length);
+    std::istringstream iss(number + " -" + number);
+    BigInteger a, b;
+    iss >> a >> b;
+    assert(a == BigInteger(number));
+    assert(b == -a);
+    assert(a.toString() == BigInteger(number).toString());
+  }
+
+  std::istringstream numbers("  00012\n-0 +7\t123456789123456789123 -999999999 oops 5");
+  std::vector<BigInteger> read = ReadBigIntegers(numbers);
+  assert(read.size() == 5);
+  assert(read[0] == 12 && read[1] == 0 && read[2] == 7 && read[4] == -999999999);
+  assert(read[3].toString() == "123456789123456789123");
+  assert(numbers.fail());
+
+  std::istringstream tail("42");
+  BigInteger c;
+  tail >> c;
+  assert(c == 42 && tail.eof() && !tail.fail());
+}
+
+void continued_fraction_test() {
+  std::cout << "Rational continued fraction test started!" << std::endl;
+  auto terms = [](const Rational& r) {
+    std::vector<std::string> result;
+    for (auto cf = r.continuedFraction(); cf.HasNext();) {
+      result.push_back(cf.Next().toString());
+    }
+    return result;
+  };
+  assert((terms(Rational(415, 93)) == std::vector<std::string>{"4", "2", "6", "7"}));
+  assert((terms(Rational(-415, 93)) == std::vector<std::string>{"-5", "1", "1", "6", "7"}));
+  assert((terms(Rational(0)) == std::vector<std::string>{"0"}));
+
+  Rational pi(BigInteger("3141592653589793"), BigInteger("1000000000000000"));
+  assert(pi.limitDenominator(10) == Rational(22, 7));
+  assert(pi.limitDenominator(100) == Rational(311, 99));
+  assert(pi.limitDenominator(1000) == Rational(355, 113));
+  assert((-pi).limitDenominator(1000) == Rational(-355, 113));
+  assert(Rational(1, 3).limitDenominator(5) == Rational(1, 3));
+  bool thrown = false;
+  try {
+    pi.limitDenominator(0);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  assert(Rational::fromDouble(0.1, 1000) == Rational(1, 10));
+  assert(Rational::fromDouble(3.141592653589793, 1000) == Rational(355, 113));
+  assert(Rational::fromDouble(-0.75, 10) == Rational(-3, 4));
+  assert(Rational::fromDouble(1e10, 1) == Rational(10'000'000'000));
+  assert(Rational::fromDouble(0.0, 7) == Rational(0));
+}
+
+void dot_test() {
+  std::cout << "Rational dot test started!" << std::endl;
+  std::random_device dev;
+  std::mt19937 rnd(dev());
+  std::uniform_int_distribution<int64_t> number(-50, 50);
+  std::uniform_int_distribution<int64_t> denominator(1, 12);
+
+  for (size_t round = 0; round < 20; ++round) {
+    std::vector<Rational> x, y;
+    for (size_t i = 0; i < 60; ++i) {
+      x.emplace_back(number(rnd), denominator(rnd));
+      y.emplace_back(number(rnd), round % 2 == 0 ? 1 : denominator(rnd));
+    }
+    Rational expected_dot, expected_sum;
+    for (size_t i = 0; i < x.size(); ++i) {
+      expected_dot += x[i] * y[i];
+      expected_sum += x[i];
+    }
+    assert(Rational::dot(x, y) == expected_dot);
+    assert(Rational::sum(x) == expected_sum);
+  }
+  assert(Rational::sum({}) == 0);
+  std::vector<Rational> halves = {Rational(1, 2), Rational(-1, 2), Rational(3, 2)};
+  assert(Rational::dot(halves, halves) == Rational(11, 4));
+  bool thrown = false;
+  try {
+    Rational::dot(halves, std::span<const Rational>(halves).first(2));
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  BigInteger acc = -5;
+  acc.AddProduct(BigInteger("123456789123456789"), BigInteger(-1000));
+  assert(acc == BigInteger("-123456789123456789005"));
+  acc.SubProduct(BigInteger("123456789123456789"), BigInteger(-1000));
+  assert(acc == -5);
+}
+
+void interval_test() {
+  std::cout << "Rational interval test started!" << std::endl;
+  // Values whose doubles coincide must fall through to the exact comparison.
+  BigInteger big("1000000000000000000000000000000");
+  Rational a(big, big + 1), b(big + 1, big + 2);
+  assert(a < b && b > a && a != b);
+  Rational neg_a = a, neg_b = b;
+  assert(-neg_a > -neg_b && neg_a.abs() == a);
+  // Far outside the double range the interval is unbounded and still correct.
+  BigInteger huge = 1;
+  for (int i = 0; i < 40; ++i) {
+    huge *= big;
+  }
+  Rational large(huge), larger(huge + 1), tiny(1, huge), tinier(1, huge + 1);
+  Rational neg_large = large, neg_larger = larger, neg_tiny = tiny, neg_tinier = tinier;
+  assert(large < larger && -neg_larger < -neg_large && large > 1);
+  assert(tinier < tiny && -neg_tiny < -neg_tinier && tiny > 0 && tiny < Rational(1, 1000));
+  assert(Rational(1, 3) < Rational(1, 2) && Rational(-7, 3) < Rational(-2));
+  std::random_device dev;
+  std::mt19937 rnd(dev());
+  std::uniform_int_distribution<int64_t> number(-1000, 1000);
+  for (size_t i = 0; i < 2000; ++i) {
+    int64_t p = number(rnd), q = number(rnd) % 30 + 31, r = number(rnd), s = number(rnd) % 30 + 31;
+    assert((Rational(p, q) <=> Rational(r, s)) == (p * s <=> r * q));
+  }
+}
+
 int main() {
+  interval_test();
+  arena_test();
+  dot_test();
+  continued_fraction_test();
+  stream_test();
+  hash_test();
+  batch_test();
   random_test();
   hard_test();
   long_divide_test();
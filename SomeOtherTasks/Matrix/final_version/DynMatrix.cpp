@@ -0,0 +1,302 @@
+#pragma once
+
+#include "DynMatrix.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Gauss.cpp"
+#include "Gemm.cpp"
+#include "Kernels.cpp"
+#include "ThreadPool.cpp"
+#include "Matrix.cpp"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Dynamic matrix//////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+template<typename Field>
+DynMatrix<Field>::DynMatrix(size_t rows, size_t cols)
+    : rows_(rows), cols_(cols), stride_(Stride(cols)), data_(rows * stride_) {}
+
+template<typename Field>
+DynMatrix<Field>::DynMatrix(size_t rows, size_t cols, const Field& value) : DynMatrix(rows, cols) {
+  for (size_t row = 0; row < rows_; ++row) {
+    std::fill((*this)[row].begin(), (*this)[row].end(), value);
+  }
+}
+
+template<typename Field>
+DynMatrix<Field>::DynMatrix(const std::initializer_list<std::initializer_list<Field>>& list)
+    : DynMatrix(list.size(), list.size() == 0 ? 0 : list.begin()->size()) {
+  size_t i = 0;
+  for (auto& row : list) {
+    if (row.size() != cols_) {
+      throw std::invalid_argument("DynMatrix: rows of different length");
+    }
+    std::copy(row.begin(), row.end(), (*this)[i].begin());
+    ++i;
+  }
+}
+
+template<typename Field>
+template<size_t M, size_t N>
+DynMatrix<Field>::DynMatrix(const Matrix<M, N, Field>& m) : DynMatrix(M, N) {
+  for (size_t row = 0; row < M; ++row) {
+    std::copy(m[row].begin(), m[row].end(), (*this)[row].begin());
+  }
+}
+
+template<typename Field>
+DynMatrix<Field>::DynMatrix(MatrixView<const Field> view) : DynMatrix(view.rows(), view.cols()) {
+  for (size_t row = 0; row < rows_; ++row) {
+    std::copy(view[row].begin(), view[row].end(), (*this)[row].begin());
+  }
+}
+
+template<typename Field>
+DynMatrix<Field> DynMatrix<Field>::identity(size_t n) {
+  DynMatrix result(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    result[i][i] = 1;
+  }
+  return result;
+}
+
+template<typename Field>
+size_t DynMatrix<Field>::Stride(size_t cols) {
+  if (kAlignment % sizeof(Field) != 0) {
+    return cols;
+  }
+  size_t per_line = kAlignment / sizeof(Field);
+  return (cols + per_line - 1) / per_line * per_line;
+}
+
+template<typename Field>
+void DynMatrix<Field>::CheckSquare() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("DynMatrix: matrix is not square");
+  }
+}
+
+template<typename Field>
+void DynMatrix<Field>::CheckSameShape(const DynMatrix& m) const {
+  if (rows_ != m.rows_ || cols_ != m.cols_) {
+    throw std::invalid_argument("DynMatrix: shapes do not match");
+  }
+}
+
+////////////////////////////////Views///////////////////////////////////////////////
+template<typename Field>
+std::span<Field> DynMatrix<Field>::operator[](size_t idx) {
+  return {data_.data() + idx * stride_, cols_};
+}
+template<typename Field>
+std::span<const Field> DynMatrix<Field>::operator[](size_t idx) const {
+  return {data_.data() + idx * stride_, cols_};
+}
+
+template<typename Field>
+MatrixView<Field> DynMatrix<Field>::view() {
+  return {data_.data(), rows_, cols_, stride_};
+}
+template<typename Field>
+MatrixView<const Field> DynMatrix<Field>::view() const {
+  return {data_.data(), rows_, cols_, stride_};
+}
+template<typename Field>
+MatrixView<Field> DynMatrix<Field>::block(size_t row, size_t col, size_t rows, size_t cols) {
+  return view().block(row, col, rows, cols);
+}
+template<typename Field>
+MatrixView<const Field> DynMatrix<Field>::block(size_t row, size_t col, size_t rows, size_t cols) const {
+  return view().block(row, col, rows, cols);
+}
+
+////////////////////////////////Matrix functions////////////////////////////////////
+template<typename Field>
+Field DynMatrix<Field>::det(ThreadPool* pool) const {
+  CheckSquare();
+  DynMatrix copy = *this;
+  return Gauss::Det(copy.view(), pool);
+}
+
+template<typename Field>
+size_t DynMatrix<Field>::rank(ThreadPool* pool) const {
+  DynMatrix copy = *this;
+  return Gauss::Rank(copy.view(), pool);
+}
+
+template<typename Field>
+Field DynMatrix<Field>::trace() const {
+  CheckSquare();
+  Field result = 0;
+  for (size_t i = 0; i < rows_; ++i) {
+    result += (*this)[i][i];
+  }
+  return result;
+}
+
+// Goes tile by tile so that both the rows read and the rows written stay in cache.
+template<typename Field>
+DynMatrix<Field> DynMatrix<Field>::transposed() const {
+  const size_t kTile = 32;
+  DynMatrix result(cols_, rows_);
+  for (size_t row_tile = 0; row_tile < rows_; row_tile += kTile) {
+    for (size_t col_tile = 0; col_tile < cols_; col_tile += kTile) {
+      for (size_t row = row_tile; row < std::min(rows_, row_tile + kTile); ++row) {
+        for (size_t col = col_tile; col < std::min(cols_, col_tile + kTile); ++col) {
+          result[col][row] = (*this)[row][col];
+        }
+      }
+    }
+  }
+  return result;
+}
+
+template<typename Field>
+void DynMatrix<Field>::invert(ThreadPool* pool) {
+  CheckSquare();
+  DynMatrix e = identity(rows_);
+  Gauss::Invert(view(), e.view(), pool);
+  *this = std::move(e);
+}
+
+template<typename Field>
+DynMatrix<Field> DynMatrix<Field>::inverted(ThreadPool* pool) const {
+  DynMatrix result = *this;
+  result.invert(pool);
+  return result;
+}
+
+////////////////////////////////Matrix operators////////////////////////////////////
+template<typename Field>
+DynMatrix<Field>& DynMatrix<Field>::operator+=(const DynMatrix& m) {
+  CheckSameShape(m);
+  for (size_t row = 0; row < rows_; ++row) {
+    Kernels::Add((*this)[row].data(), m[row].data(), cols_);
+  }
+  return *this;
+}
+template<typename Field>
+DynMatrix<Field>& DynMatrix<Field>::operator-=(const DynMatrix& m) {
+  CheckSameShape(m);
+  for (size_t row = 0; row < rows_; ++row) {
+    Kernels::Sub((*this)[row].data(), m[row].data(), cols_);
+  }
+  return *this;
+}
+template<typename Field>
+DynMatrix<Field>& DynMatrix<Field>::operator*=(const Field& f) {
+  for (size_t row = 0; row < rows_; ++row) {
+    Kernels::Scale((*this)[row].data(), f, cols_);
+  }
+  return *this;
+}
+template<typename Field>
+DynMatrix<Field>& DynMatrix<Field>::operator*=(const DynMatrix& m) {
+  if (m.rows_ != m.cols_) {
+    return *this = *this * m;
+  }
+  if (cols_ != m.rows_) {
+    throw std::invalid_argument("DynMatrix: shapes do not match");
+  }
+  Gemm::MultiplyInPlace(view(), m.view());
+  return *this;
+}
+
+template<typename Field>
+DynMatrix<Field> DynMatrix<Field>::pow(uint64_t k) const {
+  CheckSquare();
+  DynMatrix result(rows_, cols_);
+  DynMatrix scratch(rows_, cols_);
+  Gemm::Power(view(), k, result.view(), scratch.view());
+  return result;
+}
+
+template<typename Field>
+DynMatrix<Field> operator*(const DynMatrix<Field>& m1, const DynMatrix<Field>& m2) {
+  if (m1.cols() != m2.rows()) {
+    throw std::invalid_argument("DynMatrix: shapes do not match");
+  }
+  DynMatrix<Field> result(m1.rows(), m2.cols());
+  Gemm::MultiplyAdd(m1.view(), m2.view(), result.view());
+  return result;
+}
+template<typename Field>
+std::optional<DynMatrix<Field>> solve(const DynMatrix<Field>& a, const DynMatrix<Field>& b, ThreadPool* pool) {
+  if (a.rows() != a.cols() || b.rows() != a.rows()) {
+    throw std::invalid_argument("DynMatrix: shapes do not match");
+  }
+  DynMatrix<Field> copy = a;
+  DynMatrix<Field> x = b;
+  if (!Gauss::Solve(copy.view(), x.view(), pool)) {
+    return std::nullopt;
+  }
+  return x;
+}
+template<typename Field>
+bool operator==(const DynMatrix<Field>& m1, const DynMatrix<Field>& m2) {
+  if (m1.rows() != m2.rows() || m1.cols() != m2.cols()) {
+    return false;
+  }
+  for (size_t row = 0; row < m1.rows(); ++row) {
+    if (!std::equal(m1[row].begin(), m1[row].end(), m2[row].begin())) {
+      return false;
+    }
+  }
+  return true;
+}
+template<typename Field>
+bool operator!=(const DynMatrix<Field>& m1, const DynMatrix<Field>& m2) {
+  return !(m1 == m2);
+}
+template<typename Field>
+DynMatrix<Field> operator+(DynMatrix<Field> m1, const DynMatrix<Field>& m2) {
+  return m1 += m2;
+}
+template<typename Field>
+DynMatrix<Field> operator-(DynMatrix<Field> m1, const DynMatrix<Field>& m2) {
+  return m1 -= m2;
+}
+template<typename Field>
+DynMatrix<Field> operator*(DynMatrix<Field> m, const std::type_identity_t<Field>& f) {
+  return m *= f;
+}
+template<typename Field>
+DynMatrix<Field> operator*(const std::type_identity_t<Field>& f, DynMatrix<Field> m) {
+  return m *= f;
+}
+template<typename Field>
+std::ostream& operator<<(std::ostream& out, const DynMatrix<Field>& m) {
+  for (size_t row = 0; row < m.rows(); ++row) {
+    for (size_t col = 0; col < m.cols(); ++col) {
+      out << m[row][col] << " ";
+    }
+    out << "\n";
+  }
+  return out;
+}
+template<typename Field>
+std::istream& operator>>(std::istream& in, DynMatrix<Field>& m) {
+  for (size_t row = 0; row < m.rows(); ++row) {
+    for (size_t col = 0; col < m.cols(); ++col) {
+      in >> m[row][col];
+    }
+  }
+  return in;
+}
+
+////////////////////////////////Matrix getters//////////////////////////////////////
+template<typename Field>
+std::vector<Field> DynMatrix<Field>::getRow(size_t idx) const {
+  return {(*this)[idx].begin(), (*this)[idx].end()};
+}
+template<typename Field>
+std::vector<Field> DynMatrix<Field>::getColumn(size_t idx) const {
+  std::vector<Field> column(rows_);
+  for (size_t row = 0; row < rows_; ++row) {
+    column[row] = (*this)[row][idx];
+  }
+  return column;
+}
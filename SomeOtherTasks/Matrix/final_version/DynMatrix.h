@@ -0,0 +1,145 @@
+#ifndef DYN_MATRIX_H_
+#define DYN_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Aligned allocator///////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t Alignment = 64>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+  template<typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+  }
+  void deallocate(T* ptr, size_t) {
+    ::operator delete(ptr, std::align_val_t(Alignment));
+  }
+
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Dynamic matrix//////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Matrix with runtime dimensions in one cache-line aligned row-major buffer.
+// Rows are padded to a whole number of cache lines, so every row starts aligned.
+template<typename Field = int64_t>
+class DynMatrix {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  DynMatrix() = default;
+  DynMatrix(size_t rows, size_t cols);
+  DynMatrix(size_t rows, size_t cols, const Field& value);
+  DynMatrix(const std::initializer_list<std::initializer_list<Field>>& list);
+  template<size_t M, size_t N>
+  explicit DynMatrix(const Matrix<M, N, Field>&);
+  explicit DynMatrix(MatrixView<const Field>);
+
+  static DynMatrix identity(size_t n);
+
+  std::span<Field> operator[](size_t);
+  std::span<const Field> operator[](size_t) const;
+
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t stride() const { return stride_; }
+
+  MatrixView<Field> view();
+  MatrixView<const Field> view() const;
+  MatrixView<Field> block(size_t row, size_t col, size_t rows, size_t cols);
+  MatrixView<const Field> block(size_t row, size_t col, size_t rows, size_t cols) const;
+
+  DynMatrix& operator+=(const DynMatrix&);
+  DynMatrix& operator-=(const DynMatrix&);
+  DynMatrix& operator*=(const Field&);
+  DynMatrix& operator*=(const DynMatrix&);
+
+  // this^k by binary powering, O(n^3 log k); k = 0 gives the identity.
+  DynMatrix pow(uint64_t k) const;
+
+  // Given a pool, elimination runs on its threads.
+  Field det(ThreadPool* pool = nullptr) const;
+  size_t rank(ThreadPool* pool = nullptr) const;
+  Field trace() const;
+  DynMatrix transposed() const;
+  void invert(ThreadPool* pool = nullptr);
+  DynMatrix inverted(ThreadPool* pool = nullptr) const;
+
+  std::vector<Field> getRow(size_t) const;
+  std::vector<Field> getColumn(size_t) const;
+
+ private:
+  static size_t Stride(size_t cols);
+  void CheckSquare() const;
+  void CheckSameShape(const DynMatrix&) const;
+
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t stride_ = 0;
+  std::vector<Field, AlignedAllocator<Field, kAlignment>> data_;
+};
+
+template<typename Field>
+DynMatrix<Field> operator*(const DynMatrix<Field>&, const DynMatrix<Field>&);
+
+// x with a * x = b for a square a, one column of x per column of b, or std::nullopt
+// when a is singular. Throws std::invalid_argument when the shapes do not match.
+template<typename Field>
+std::optional<DynMatrix<Field>> solve(const DynMatrix<Field>& a, const DynMatrix<Field>& b,
+                                      ThreadPool* pool = nullptr);
+
+template<typename Field>
+bool operator==(const DynMatrix<Field>&, const DynMatrix<Field>&);
+
+template<typename Field>
+bool operator!=(const DynMatrix<Field>&, const DynMatrix<Field>&);
+
+template<typename Field>
+DynMatrix<Field> operator+(DynMatrix<Field>, const DynMatrix<Field>&);
+
+template<typename Field>
+DynMatrix<Field> operator-(DynMatrix<Field>, const DynMatrix<Field>&);
+
+template<typename Field>
+DynMatrix<Field> operator*(DynMatrix<Field>, const std::type_identity_t<Field>&);
+
+template<typename Field>
+DynMatrix<Field> operator*(const std::type_identity_t<Field>&, DynMatrix<Field>);
+
+template<typename Field>
+std::ostream& operator<<(std::ostream&, const DynMatrix<Field>&);
+
+// Reads rows() * cols() elements into an already shaped matrix.
+template<typename Field>
+std::istream& operator>>(std::istream&, DynMatrix<Field>&);
+
+#endif //DYN_MATRIX_H_
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "DynResidue.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "FastResidue.h"
+
+////////////////////////////////Runtime modulus/////////////////////////////////////
+inline ModulusContext::ModulusContext(uint64_t modulus) {
+  if (modulus < 2 || modulus > UINT32_MAX) {
+    throw std::invalid_argument("ModulusContext: modulus must be in [2, 2^32)");
+  }
+  modulus_ = static_cast<uint32_t>(modulus);
+  reciprocal_ = static_cast<uint64_t>(((unsigned __int128)1 << 64) / modulus);
+  prime_ = Operators::IsPrime(modulus);
+}
+
+inline uint32_t ModulusContext::Reduce(uint64_t product) const {
+  // The estimated quotient is at most one short.
+  uint64_t quotient = static_cast<uint64_t>(((unsigned __int128)product * reciprocal_) >> 64);
+  uint64_t rem = product - quotient * modulus_;
+  return static_cast<uint32_t>(rem >= modulus_ ? rem - modulus_ : rem);
+}
+
+inline const ModulusContext* ModulusScope::Current() {
+  return current_;
+}
+
+inline const ModulusContext& ModulusScope::Required() {
+  if (current_ == nullptr) {
+    throw std::logic_error("DynResidue: no ModulusScope on this thread");
+  }
+  return *current_;
+}
+
+inline const ModulusContext* ModulusScope::Enter(const ModulusContext* context) {
+  return std::exchange(current_, context);
+}
+
+inline ModulusScope::ModulusScope(uint64_t modulus) : own_(std::in_place, modulus), previous_(Enter(&*own_)) {}
+
+inline ModulusScope::ModulusScope(const ModulusContext* context) : previous_(Enter(context)) {}
+
+inline ModulusScope::~ModulusScope() {
+  current_ = previous_;
+}
+
+////////////////////////////////Dynamic residue/////////////////////////////////////
+inline DynResidue::DynResidue(int64_t num) {
+  uint64_t modulus = ModulusScope::Required().modulus();
+  uint64_t magnitude = num < 0 ? 0 - uint64_t(num) : uint64_t(num);
+  uint64_t rem = magnitude < modulus ? magnitude : magnitude % modulus;
+  number = static_cast<uint32_t>(num < 0 && rem != 0 ? modulus - rem : rem);
+}
+
+inline DynResidue DynResidue::inverse() const {
+  DynResidue result;
+  result.number = static_cast<uint32_t>(Operators::InverseMod(number, ModulusScope::Required().modulus()));
+  return result;
+}
+
+inline DynResidue& DynResidue::operator+=(const DynResidue& r) {
+  uint64_t modulus = ModulusScope::Required().modulus();
+  uint64_t sum = uint64_t(number) + r.number;
+  number = static_cast<uint32_t>(sum >= modulus ? sum - modulus : sum);
+  return *this;
+}
+
+inline DynResidue& DynResidue::operator-=(const DynResidue& r) {
+  uint32_t modulus = ModulusScope::Required().modulus();
+  number = number >= r.number ? number - r.number : number + (modulus - r.number);
+  return *this;
+}
+
+inline DynResidue& DynResidue::operator*=(const DynResidue& r) {
+  number = ModulusScope::Required().Reduce(uint64_t(number) * r.number);
+  return *this;
+}
+
+inline DynResidue& DynResidue::operator/=(const DynResidue& r) {
+  if (!ModulusScope::Required().prime()) {
+    throw std::domain_error("DynResidue: division needs a prime modulus");
+  }
+  return *this *= r.inverse();
+}
+
+inline DynResidue operator+(DynResidue r1, const DynResidue& r2) {
+  return r1 += r2;
+}
+inline DynResidue operator-(DynResidue r1, const DynResidue& r2) {
+  return r1 -= r2;
+}
+inline DynResidue operator*(DynResidue r1, const DynResidue& r2) {
+  return r1 *= r2;
+}
+inline DynResidue operator/(DynResidue r1, const DynResidue& r2) {
+  return r1 /= r2;
+}
+inline std::ostream& operator<<(std::ostream& os, const DynResidue& r) {
+  os << r.number;
+  return os;
+}
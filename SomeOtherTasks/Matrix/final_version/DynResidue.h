@@ -0,0 +1,106 @@
+#ifndef DYN_RESIDUE_H_
+#define DYN_RESIDUE_H_
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+
+#include "Gauss.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Runtime modulus/////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Modulus of DynResidue arithmetic together with the constants of its reductions,
+// computed once per modulus rather than once per operation.
+class ModulusContext {
+ public:
+  // Throws std::invalid_argument unless 2 <= modulus < 2^32.
+  explicit ModulusContext(uint64_t modulus);
+
+  uint32_t modulus() const { return modulus_; }
+  bool prime() const { return prime_; }
+
+  // product mod modulus for any product < 2^64, by Barrett with floor(2^64 / modulus).
+  uint32_t Reduce(uint64_t product) const;
+
+ private:
+  uint32_t modulus_;
+  uint64_t reciprocal_;
+  bool prime_;
+};
+
+// Scope that sets the modulus of all DynResidue arithmetic on this thread until it
+// is destroyed; scopes nest and the previous modulus comes back on exit.
+class ModulusScope {
+ public:
+  explicit ModulusScope(uint64_t modulus);
+  // Borrows a context that outlives the scope; nullptr leaves the thread without one.
+  explicit ModulusScope(const ModulusContext* context);
+
+  ModulusScope(const ModulusScope&) = delete;
+  ModulusScope& operator=(const ModulusScope&) = delete;
+  ~ModulusScope();
+
+  // Context of the innermost scope on this thread, nullptr outside any.
+  static const ModulusContext* Current();
+  // The same context for arithmetic that needs one; throws std::logic_error outside any.
+  static const ModulusContext& Required();
+
+ private:
+  static const ModulusContext* Enter(const ModulusContext*);
+  // Innermost context on this thread.
+  static inline thread_local const ModulusContext* current_ = nullptr;
+  std::optional<ModulusContext> own_;
+  const ModulusContext* previous_;
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Dynamic residue/////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Residue modulo the modulus of the innermost ModulusScope, for moduli known only at
+// run time: read from input, or the primes of a multi-modular computation. Values
+// must not outlive the scope they were made in or meet values of another modulus.
+class DynResidue {
+  friend std::ostream& operator<<(std::ostream& os, const DynResidue& r);
+ public:
+  DynResidue() = default;
+  // Throws std::logic_error outside a ModulusScope.
+  DynResidue(int64_t num);
+  explicit operator int() const { return static_cast<int>(number); }
+  DynResidue abs() const { return *this; }
+  // Operators::InverseMod: throws std::domain_error unless number is coprime to the modulus.
+  DynResidue inverse() const;
+
+  DynResidue& operator+=(const DynResidue& r);
+  DynResidue& operator-=(const DynResidue& r);
+  DynResidue& operator*=(const DynResidue& r);
+  // Throws std::domain_error when the modulus is not prime.
+  DynResidue& operator/=(const DynResidue& r);
+
+  friend bool operator==(const DynResidue&, const DynResidue&) = default;
+  friend auto operator<=>(const DynResidue&, const DynResidue&) = default;
+
+ private:
+  uint32_t number = 0;
+};
+
+DynResidue operator+(DynResidue r1, const DynResidue& r2);
+DynResidue operator-(DynResidue r1, const DynResidue& r2);
+DynResidue operator*(DynResidue r1, const DynResidue& r2);
+DynResidue operator/(DynResidue r1, const DynResidue& r2);
+std::ostream& operator<<(std::ostream& os, const DynResidue& r);
+
+// Pool threads doing elimination over DynResidue take the caller's modulus.
+namespace Gauss {
+template<>
+struct FieldContext<DynResidue> {
+  using Scope = ModulusScope;
+  static const ModulusContext* Current() { return ModulusScope::Current(); }
+};
+}
+
+#endif //DYN_RESIDUE_H_
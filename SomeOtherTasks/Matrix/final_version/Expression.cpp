@@ -0,0 +1,259 @@
+#pragma once
+
+#include "Expression.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "Gemm.cpp"
+#include "Kernels.cpp"
+#include "Matrix.h"
+#include "SmallMatrix.cpp"
+
+namespace Lazy {
+
+template<typename T>
+struct IsLeaf : std::false_type {};
+template<size_t M, size_t N, typename Field>
+struct IsLeaf<Leaf<M, N, Field>> : std::true_type {};
+
+template<typename T>
+struct IsProduct : std::false_type {};
+template<typename L, typename R>
+struct IsProduct<Product<L, R>> : std::true_type {};
+
+// Small::Multiply takes products up to Small::kMaxSize in each dimension.
+template<typename L, typename R>
+inline constexpr bool kSmallProduct = L::kCols != 0 && L::kRows <= Small::kMaxSize &&
+                                      L::kCols <= Small::kMaxSize && R::kCols <= Small::kMaxSize;
+
+// out += coef * src, with the plain row kernels for coef = 1 and coef = -1.
+template<typename Field>
+void AddScaled(Field* out, const Field* src, const Field& coef, size_t count) {
+  if (coef == Field(1)) {
+    Kernels::Add(out, src, count);
+  } else if (coef == Field(0) - Field(1)) {
+    Kernels::Sub(out, src, count);
+  } else {
+    Kernels::AddScaled(out, src, coef, count);
+  }
+}
+
+// body(the node as a Matrix): a Leaf passes its matrix, anything else its value.
+template<typename T, typename Body>
+void WithMatrix(const T& node, Body&& body) {
+  if constexpr (IsLeaf<T>::value) {
+    body(node.matrix());
+  } else {
+    body(node.eval());
+  }
+}
+
+template<typename Derived>
+auto Expression<Derived>::eval() const {
+  return Matrix<Derived::kRows, Derived::kCols, typename Derived::Field>(derived());
+}
+
+template<typename T>
+NodeOf<T> Wrap(const T& operand) {
+  return NodeOf<T>(operand);
+}
+
+////////////////////////////////Leaf////////////////////////////////////////////////
+template<size_t M, size_t N, typename F>
+void Leaf<M, N, F>::EvalRow(size_t row, Field* out) const {
+  const Field* src = matrix_[row].data();
+  if (src != out) {
+    std::copy(src, src + N, out);
+  }
+}
+
+template<size_t M, size_t N, typename F>
+void Leaf<M, N, F>::AddRow(size_t row, Field* out, const Field& coef) const {
+  AddScaled(out, matrix_[row].data(), coef, N);
+}
+
+template<size_t M, size_t N, typename F>
+bool Leaf<M, N, F>::Reads(const Field* data) const {
+  return matrix_.view().data() == data;
+}
+
+////////////////////////////////Sum/////////////////////////////////////////////////
+template<typename L, typename R, bool Subtract>
+void Sum<L, R, Subtract>::EvalRow(size_t row, Field* out) const {
+  if constexpr (L::kElementwise) {
+    left_.EvalRow(row, out);
+    if constexpr (R::kElementwise) {
+      right_.AddRow(row, out, Subtract ? Field(0) - Field(1) : Field(1));
+    }
+  } else {
+    right_.EvalRow(row, out);
+    if constexpr (Subtract) {
+      Kernels::Scale(out, Field(0) - Field(1), kCols);
+    }
+  }
+}
+
+template<typename L, typename R, bool Subtract>
+void Sum<L, R, Subtract>::AddRow(size_t row, Field* out, const Field& coef) const {
+  if constexpr (L::kElementwise) {
+    left_.AddRow(row, out, coef);
+  }
+  if constexpr (R::kElementwise) {
+    right_.AddRow(row, out, Subtract ? Field(0) - coef : coef);
+  }
+}
+
+template<typename L, typename R, bool Subtract>
+void Sum<L, R, Subtract>::AddProducts(MatrixView<Field> dst, const Field& scale) const {
+  left_.AddProducts(dst, scale);
+  right_.AddProducts(dst, Subtract ? Field(0) - scale : scale);
+}
+
+template<typename L, typename R, bool Subtract>
+bool Sum<L, R, Subtract>::Reads(const Field* data) const {
+  return left_.Reads(data) || right_.Reads(data);
+}
+
+template<typename L, typename R, bool Subtract>
+bool Sum<L, R, Subtract>::ProductReads(const Field* data) const {
+  return left_.ProductReads(data) || right_.ProductReads(data);
+}
+
+////////////////////////////////Scaled//////////////////////////////////////////////
+template<typename E>
+void Scaled<E>::EvalRow(size_t row, Field* out) const {
+  expr_.EvalRow(row, out);
+  Kernels::Scale(out, factor_, kCols);
+}
+
+template<typename E>
+void Scaled<E>::AddRow(size_t row, Field* out, const Field& coef) const {
+  expr_.AddRow(row, out, coef * factor_);
+}
+
+template<typename E>
+void Scaled<E>::AddProducts(MatrixView<Field> dst, const Field& scale) const {
+  expr_.AddProducts(dst, scale * factor_);
+}
+
+template<typename E>
+bool Scaled<E>::Reads(const Field* data) const {
+  return expr_.Reads(data);
+}
+
+template<typename E>
+bool Scaled<E>::ProductReads(const Field* data) const {
+  return expr_.ProductReads(data);
+}
+
+////////////////////////////////Product/////////////////////////////////////////////
+template<typename L, typename R>
+void Product<L, R>::AddProducts(MatrixView<Field> dst, const Field& scale) const {
+  WithMatrix(left_, [&](const auto& a) {
+    WithMatrix(right_, [&](const auto& b) {
+      if constexpr (kSmallProduct<L, R>) {
+        auto product = Small::Multiply(a, b);
+        for (size_t row = 0; row < kRows; ++row) {
+          AddScaled(dst[row].data(), product[row].data(), scale, kCols);
+        }
+      } else if (scale == Field(1)) {
+        Gemm::MultiplyAdd(a.view(), b.view(), dst);
+      } else {
+        // GEMM only accumulates, so the scale goes into a copy of the left factor.
+        auto scaled = a;
+        scaled *= scale;
+        Gemm::MultiplyAdd(std::as_const(scaled).view(), b.view(), dst);
+      }
+    });
+  });
+}
+
+template<typename L, typename R>
+void Product<L, R>::AssignTo(MatrixView<Field> dst) const {
+  if constexpr (kSmallProduct<L, R>) {
+    WithMatrix(left_, [&](const auto& a) {
+      WithMatrix(right_, [&](const auto& b) {
+        auto product = Small::Multiply(a, b);
+        for (size_t row = 0; row < kRows; ++row) {
+          std::copy(product[row].begin(), product[row].end(), dst[row].begin());
+        }
+      });
+    });
+  } else {
+    for (size_t row = 0; row < kRows; ++row) {
+      std::fill(dst[row].begin(), dst[row].end(), Field(0));
+    }
+    AddProducts(dst, Field(1));
+  }
+}
+
+template<typename L, typename R>
+bool Product<L, R>::Reads(const Field* data) const {
+  return left_.Reads(data) || right_.Reads(data);
+}
+
+////////////////////////////////Evaluation//////////////////////////////////////////
+template<typename Expr>
+void Assign(const Expr& expr, MatrixView<typename Expr::Field> dst) {
+  using Field = typename Expr::Field;
+  if (expr.ProductReads(dst.data())) {
+    // A product mixes rows, so it must not see the destination half written.
+    std::vector<Field> buffer(Expr::kRows * Expr::kCols);
+    MatrixView<Field> value(buffer.data(), Expr::kRows, Expr::kCols, Expr::kCols);
+    Assign(expr, value);
+    for (size_t row = 0; row < Expr::kRows; ++row) {
+      std::copy(value[row].begin(), value[row].end(), dst[row].begin());
+    }
+    return;
+  }
+  if constexpr (Expr::kElementwise) {
+    // Element-wise terms read only the same row, so when one of them is the
+    // destination it is enough to build each row aside before writing it.
+    std::vector<Field> aside(expr.Reads(dst.data()) ? Expr::kCols : 0);
+    for (size_t row = 0; row < Expr::kRows; ++row) {
+      Field* out = aside.empty() ? dst[row].data() : aside.data();
+      expr.EvalRow(row, out);
+      if (!aside.empty()) {
+        std::copy(aside.begin(), aside.end(), dst[row].begin());
+      }
+    }
+  } else if constexpr (IsProduct<Expr>::value) {
+    expr.AssignTo(dst);
+    return;
+  } else {
+    for (size_t row = 0; row < Expr::kRows; ++row) {
+      std::fill(dst[row].begin(), dst[row].end(), Field(0));
+    }
+  }
+  expr.AddProducts(dst, Field(1));
+}
+
+template<typename Expr>
+void Accumulate(const Expr& expr, MatrixView<typename Expr::Field> dst, const typename Expr::Field& coef) {
+  using Field = typename Expr::Field;
+  if (expr.ProductReads(dst.data())) {
+    auto value = expr.eval();
+    for (size_t row = 0; row < Expr::kRows; ++row) {
+      AddScaled(dst[row].data(), value[row].data(), coef, Expr::kCols);
+    }
+    return;
+  }
+  if constexpr (Expr::kElementwise) {
+    if (expr.Reads(dst.data())) {
+      std::vector<Field> aside(Expr::kCols);
+      for (size_t row = 0; row < Expr::kRows; ++row) {
+        expr.EvalRow(row, aside.data());
+        AddScaled(dst[row].data(), aside.data(), coef, Expr::kCols);
+      }
+    } else {
+      for (size_t row = 0; row < Expr::kRows; ++row) {
+        expr.AddRow(row, dst[row].data(), coef);
+      }
+    }
+  }
+  expr.AddProducts(dst, coef);
+}
+
+}
@@ -0,0 +1,175 @@
+#ifndef EXPRESSION_H_
+#define EXPRESSION_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "MatrixView.h"
+
+template<size_t M, size_t N, typename Field>
+class Matrix;
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Lazy expressions////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Matrix +, - and * (by a matrix or a scalar) build these nodes instead of matrices,
+// and nothing is computed until the expression is assigned to a Matrix. Then every
+// row of the element-wise terms is built in place in the destination with the row
+// kernels, so A + B - C * k runs as three passes over one row in cache and makes no
+// temporary, and every product term goes through Gemm::MultiplyAdd straight into the
+// destination: D = A * B + C copies C into D and accumulates A * B on top of it.
+// Nodes refer to the matrices they were built from, so an expression must not outlive
+// them: assign it or call eval() within the statement rather than keeping it in auto.
+namespace Lazy {
+
+template<typename Derived>
+class Expression {
+ public:
+  const Derived& derived() const { return static_cast<const Derived&>(*this); }
+  // The value as a Matrix<Derived::kRows, Derived::kCols, Derived::Field>.
+  auto eval() const;
+};
+
+template<typename T>
+struct IsMatrix : std::false_type {};
+template<size_t M, size_t N, typename Field>
+struct IsMatrix<Matrix<M, N, Field>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool kIsExpression = std::is_base_of_v<Expression<T>, T>;
+
+// Matrices and expressions may be mixed freely as operands.
+template<typename T>
+inline constexpr bool kIsOperand = IsMatrix<T>::value || kIsExpression<T>;
+
+// Interface shared by the nodes below, used by evaluation:
+//   Field, kRows, kCols                the shape of the value;
+//   kElementwise                       whether any term is not a product;
+//   EvalRow(row, out)                  out = the element-wise terms of a row;
+//   AddRow(row, out, coef)             out += coef * the element-wise terms of a row;
+//   AddProducts(dst, scale)            dst += scale * the product terms;
+//   Reads(data), ProductReads(data)    whether any matrix read, or one read by a
+//                                      product (which mixes rows), starts at data.
+
+// A matrix operand.
+template<size_t M, size_t N, typename F>
+class Leaf : public Expression<Leaf<M, N, F>> {
+ public:
+  using Field = F;
+  static constexpr size_t kRows = M;
+  static constexpr size_t kCols = N;
+  static constexpr bool kElementwise = true;
+
+  explicit Leaf(const Matrix<M, N, Field>& matrix) : matrix_(matrix) {}
+  const Matrix<M, N, Field>& matrix() const { return matrix_; }
+
+  void EvalRow(size_t row, Field* out) const;
+  void AddRow(size_t row, Field* out, const Field& coef) const;
+  void AddProducts(MatrixView<Field>, const Field&) const {}
+  bool Reads(const Field* data) const;
+  bool ProductReads(const Field*) const { return false; }
+
+ private:
+  const Matrix<M, N, Field>& matrix_;
+};
+
+// L + R, or L - R when Subtract.
+template<typename L, typename R, bool Subtract>
+class Sum : public Expression<Sum<L, R, Subtract>> {
+  static_assert(std::is_same_v<typename L::Field, typename R::Field>);
+  static_assert(L::kRows == R::kRows && L::kCols == R::kCols, "Matrix shapes do not match");
+
+ public:
+  using Field = typename L::Field;
+  static constexpr size_t kRows = L::kRows;
+  static constexpr size_t kCols = L::kCols;
+  static constexpr bool kElementwise = L::kElementwise || R::kElementwise;
+
+  Sum(const L& left, const R& right) : left_(left), right_(right) {}
+
+  void EvalRow(size_t row, Field* out) const;
+  void AddRow(size_t row, Field* out, const Field& coef) const;
+  void AddProducts(MatrixView<Field> dst, const Field& scale) const;
+  bool Reads(const Field* data) const;
+  bool ProductReads(const Field* data) const;
+
+ private:
+  L left_;
+  R right_;
+};
+
+// E * factor.
+template<typename E>
+class Scaled : public Expression<Scaled<E>> {
+ public:
+  using Field = typename E::Field;
+  static constexpr size_t kRows = E::kRows;
+  static constexpr size_t kCols = E::kCols;
+  static constexpr bool kElementwise = E::kElementwise;
+
+  Scaled(const E& expr, const Field& factor) : expr_(expr), factor_(factor) {}
+
+  void EvalRow(size_t row, Field* out) const;
+  void AddRow(size_t row, Field* out, const Field& coef) const;
+  void AddProducts(MatrixView<Field> dst, const Field& scale) const;
+  bool Reads(const Field* data) const;
+  bool ProductReads(const Field* data) const;
+
+ private:
+  E expr_;
+  Field factor_;
+};
+
+// L * R, evaluated by GEMM. Operands that are expressions themselves are evaluated
+// into temporaries first.
+template<typename L, typename R>
+class Product : public Expression<Product<L, R>> {
+  static_assert(std::is_same_v<typename L::Field, typename R::Field>);
+  static_assert(L::kCols == R::kRows, "Matrix shapes do not match");
+
+ public:
+  using Field = typename L::Field;
+  static constexpr size_t kRows = L::kRows;
+  static constexpr size_t kCols = R::kCols;
+  static constexpr bool kElementwise = false;
+
+  Product(const L& left, const R& right) : left_(left), right_(right) {}
+
+  void AddProducts(MatrixView<Field> dst, const Field& scale) const;
+  // dst = the product, for a product that is the whole expression.
+  void AssignTo(MatrixView<Field> dst) const;
+  bool Reads(const Field* data) const;
+  bool ProductReads(const Field* data) const { return Reads(data); }
+
+ private:
+  L left_;
+  R right_;
+};
+
+// Leaf for a Matrix, the node itself for an expression.
+template<typename T>
+struct Node {
+  using type = T;
+};
+template<size_t M, size_t N, typename Field>
+struct Node<Matrix<M, N, Field>> {
+  using type = Leaf<M, N, Field>;
+};
+template<typename T>
+using NodeOf = typename Node<T>::type;
+
+template<typename T>
+NodeOf<T> Wrap(const T& operand);
+
+// dst = expr, for a dst that no product of expr reads.
+template<typename Expr>
+void Assign(const Expr& expr, MatrixView<typename Expr::Field> dst);
+
+// dst += coef * expr, for a dst that no product of expr reads.
+template<typename Expr>
+void Accumulate(const Expr& expr, MatrixView<typename Expr::Field> dst, const typename Expr::Field& coef);
+
+}
+
+#endif //EXPRESSION_H_
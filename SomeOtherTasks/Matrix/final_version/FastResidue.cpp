@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FastResidue.h"
+
+template<size_t N>
+FastResidue<N>::FastResidue(int64_t num) {
+  uint64_t magnitude = num < 0 ? 0 - uint64_t(num) : uint64_t(num);
+  uint64_t rem = magnitude % N;
+  number = Storage(num < 0 && rem != 0 ? N - rem : rem);
+}
+
+template<size_t N>
+typename FastResidue<N>::Storage FastResidue<N>::Reduce(Product product) {
+  if constexpr (N == 1) {
+    return 0;
+  } else if constexpr (N > (size_t(1) << 32)) {
+    return Storage(product % N);
+  } else {
+    // floor(2^64 / N) underestimates the quotient by at most one.
+    constexpr uint64_t kReciprocal = uint64_t(((unsigned __int128)1 << 64) / N);
+    uint64_t quotient = uint64_t(((unsigned __int128)product * kReciprocal) >> 64);
+    uint64_t rem = product - quotient * N;
+    return Storage(rem >= N ? rem - N : rem);
+  }
+}
+
+template<size_t N>
+FastResidue<N> FastResidue<N>::inverse() const {
+  using Signed = std::conditional_t<(N <= (size_t(1) << 62)), int64_t, __int128>;
+  FastResidue result;
+  result.number = Storage(Operators::InverseMod<Signed>(number, N));
+  return result;
+}
+
+////////////////////////////////Fast residue operators//////////////////////////////
+template<size_t N>
+FastResidue<N>& FastResidue<N>::operator+=(const FastResidue& r) {
+  Product sum = Product(number) + r.number;
+  number = Storage(sum >= N ? sum - N : sum);
+  return *this;
+}
+template<size_t N>
+FastResidue<N>& FastResidue<N>::operator-=(const FastResidue& r) {
+  number = Storage(number >= r.number ? number - r.number : number + (N - r.number));
+  return *this;
+}
+template<size_t N>
+FastResidue<N>& FastResidue<N>::operator*=(const FastResidue& r) {
+  number = Reduce(Product(number) * r.number);
+  return *this;
+}
+template<size_t N>
+FastResidue<N>& FastResidue<N>::operator/=(const FastResidue& r) {
+  static_assert(kPrime);
+  return *this *= r.inverse();
+}
+template<size_t N>
+FastResidue<N> operator+(FastResidue<N> r1, const FastResidue<N>& r2) {
+  return r1 += r2;
+}
+template<size_t N>
+FastResidue<N> operator-(FastResidue<N> r1, const FastResidue<N>& r2) {
+  return r1 -= r2;
+}
+template<size_t N>
+FastResidue<N> operator*(FastResidue<N> r1, const FastResidue<N>& r2) {
+  return r1 *= r2;
+}
+template<size_t N>
+FastResidue<N> operator/(FastResidue<N> r1, const FastResidue<N>& r2) {
+  return r1 /= r2;
+}
+template<size_t N>
+std::ostream& operator<<(std::ostream& os, const FastResidue<N>& r) {
+  os << static_cast<uint64_t>(r.number);
+  return os;
+}
@@ -0,0 +1,137 @@
+#ifndef FAST_RESIDUE_H_
+#define FAST_RESIDUE_H_
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Fast residue////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+namespace Operators {
+
+// Narrowest unsigned type that holds every residue modulo N.
+template<size_t N>
+using ResidueStorage = std::conditional_t<(N <= (size_t(1) << 8)), uint8_t,
+                       std::conditional_t<(N <= (size_t(1) << 16)), uint16_t,
+                       std::conditional_t<(N <= (size_t(1) << 32)), uint32_t, uint64_t>>>;
+
+constexpr uint64_t MulMod(uint64_t a, uint64_t b, uint64_t mod) {
+  return uint64_t((unsigned __int128)a * b % mod);
+}
+
+// Miller-Rabin with the first twelve primes as bases, exact for every 64-bit n.
+constexpr bool IsPrime(uint64_t n) {
+  if (n < 2) {
+    return false;
+  }
+  const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  for (uint64_t base : bases) {
+    if (n % base == 0) {
+      return n == base;
+    }
+  }
+  uint64_t d = n - 1;
+  size_t s = 0;
+  while (d % 2 == 0) {
+    d /= 2;
+    ++s;
+  }
+  for (uint64_t base : bases) {
+    uint64_t x = 1;
+    for (uint64_t power = base, exp = d; exp > 0; exp >>= 1, power = MulMod(power, power, n)) {
+      if (exp & 1) {
+        x = MulMod(x, power, n);
+      }
+    }
+    bool composite = x != 1 && x != n - 1;
+    for (size_t i = 1; i < s && composite; ++i) {
+      x = MulMod(x, x, n);
+      composite = x != n - 1;
+    }
+    if (composite) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// x with number * x == 1 (mod modulus) by extended Euclid, O(log modulus). Signed
+// must hold modulus. Throws std::domain_error when number is not coprime to modulus.
+template<typename Signed = int64_t>
+constexpr uint64_t InverseMod(uint64_t number, uint64_t modulus) {
+  // Keeps remainder == coef * number (mod modulus) for both rows of the algorithm.
+  Signed remainder = number;
+  Signed next_remainder = modulus;
+  Signed coef = 1;
+  Signed next_coef = 0;
+  while (next_remainder != 0) {
+    Signed quotient = remainder / next_remainder;
+    remainder = std::exchange(next_remainder, remainder - quotient * next_remainder);
+    coef = std::exchange(next_coef, coef - quotient * next_coef);
+  }
+  if (remainder != 1) {
+    throw std::domain_error("InverseMod: number is not invertible");
+  }
+  return uint64_t(coef < 0 ? coef + Signed(modulus) : coef);
+}
+
+}
+
+// Drop-in replacement for Residue<N> as a matrix Field. It stores the residue in the
+// narrowest type that fits N and never divides in hardware outside inverse(): sums
+// and differences are fixed with one conditional step, and products below 2^64
+// (N <= 2^32) are reduced by Barrett with the reciprocal computed at compile time.
+// Primality for division is checked with a constexpr Miller-Rabin, so N may be any
+// 64-bit prime rather than what the template recursion of Residue can reach.
+template<size_t N>
+class FastResidue {
+  template<size_t K>
+  friend std::ostream& operator<<(std::ostream& os, const FastResidue<K>& r);
+ public:
+  using Storage = Operators::ResidueStorage<N>;
+  // Wide enough for a product of two residues.
+  using Product = std::conditional_t<(N <= (size_t(1) << 32)), uint64_t, unsigned __int128>;
+  static constexpr bool kPrime = Operators::IsPrime(N);
+
+  FastResidue() = default;
+  FastResidue(int64_t num);
+  explicit operator int() const { return static_cast<int>(number); }
+  FastResidue abs() const { return *this; }
+  // Operators::InverseMod: throws std::domain_error unless number is coprime to N.
+  FastResidue inverse() const;
+
+  FastResidue& operator+=(const FastResidue& r);
+  FastResidue& operator-=(const FastResidue& r);
+  FastResidue& operator*=(const FastResidue& r);
+  FastResidue& operator/=(const FastResidue& r);
+
+  friend bool operator==(const FastResidue&, const FastResidue&) = default;
+  friend auto operator<=>(const FastResidue&, const FastResidue&) = default;
+
+  // Remainder of a product of two residues.
+  static Storage Reduce(Product product);
+
+ private:
+  static_assert(N != 0);
+
+  Storage number = 0;
+};
+
+template<size_t N>
+FastResidue<N> operator+(FastResidue<N> r1, const FastResidue<N>& r2);
+template<size_t N>
+FastResidue<N> operator-(FastResidue<N> r1, const FastResidue<N>& r2);
+template<size_t N>
+FastResidue<N> operator*(FastResidue<N> r1, const FastResidue<N>& r2);
+template<size_t N>
+FastResidue<N> operator/(FastResidue<N> r1, const FastResidue<N>& r2);
+template<size_t N>
+std::ostream& operator<<(std::ostream& os, const FastResidue<N>& r);
+
+#endif //FAST_RESIDUE_H_
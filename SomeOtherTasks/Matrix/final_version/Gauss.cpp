@@ -0,0 +1,317 @@
+#pragma once
+
+#include "Gauss.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "Kernels.cpp"
+#include "Modular.cpp"
+#include "ThreadPool.cpp"
+
+namespace Gauss {
+
+template<typename Field>
+Field Abs(const Field& value) {
+  if constexpr (std::is_arithmetic_v<Field>) {
+    return value < Field(0) ? -value : value;
+  } else {
+    return value.abs();
+  }
+}
+
+template<typename Field>
+void SwapRows(MatrixView<Field> a, size_t i, size_t j, size_t from) {
+  std::swap_ranges(a[i].begin() + from, a[i].end(), a[j].begin() + from);
+}
+
+// Elements below which a pivot step is not worth waking the pool for.
+const size_t kMinParallelWork = 1 << 14;
+
+template<typename Field, typename Body>
+void ForRows(ThreadPool* pool, size_t begin, size_t end, size_t width, Body&& body) {
+  if (pool == nullptr || begin >= end || (end - begin) * width < kMinParallelWork) {
+    body(begin, end);
+    return;
+  }
+  auto context = FieldContext<Field>::Current();
+  pool->ParallelFor(begin, end, [&](size_t lo, size_t hi) {
+    typename FieldContext<Field>::Scope scope(context);
+    body(lo, hi);
+  });
+}
+
+// Divides by a fixed pivot. Exact Fields invert it once and multiply, which saves a
+// division per row; floating point keeps dividing so each quotient is rounded once.
+template<typename Field>
+class PivotDivisor {
+ public:
+  explicit PivotDivisor(const Field& pivot) : factor_(pivot) {
+    if constexpr (!std::is_floating_point_v<Field>) {
+      factor_ = Field(1) / pivot;
+    }
+  }
+
+  Field operator()(const Field& value) const {
+    if constexpr (std::is_floating_point_v<Field>) {
+      return value / factor_;
+    } else {
+      return value * factor_;
+    }
+  }
+
+ private:
+  Field factor_;
+};
+
+template<typename Field>
+void InvertAll(std::span<Field> values) {
+  if (values.empty()) {
+    return;
+  }
+  std::vector<Field> prefix(values.begin(), values.end());
+  for (size_t i = 1; i < prefix.size(); ++i) {
+    prefix[i] = prefix[i - 1] * values[i];
+  }
+  Field inverse = Field(1) / prefix.back();
+  for (size_t i = values.size() - 1; i > 0; --i) {
+    Field value = values[i];
+    values[i] = inverse * prefix[i - 1];
+    inverse = inverse * value;
+  }
+  values[0] = inverse;
+}
+
+// Below this many rows Bareiss beats reducing the matrix modulo every prime.
+const size_t kModularMinSize = 8;
+
+////////////////////////////////Elimination////////////////////////////////////////
+template<typename Field>
+Field Det(MatrixView<Field> a, ThreadPool* pool) {
+  if constexpr (std::is_integral_v<Field>) {
+    if (a.rows() >= kModularMinSize) {
+      return Modular::Det<Field>(a, pool);
+    }
+  }
+  if constexpr (IsIntegralField<Field>::value) {
+    return BareissDet(a, pool);
+  } else {
+    return DivisionDet(a, pool);
+  }
+}
+
+template<typename Field>
+size_t Rank(MatrixView<Field> a, ThreadPool* pool) {
+  if constexpr (std::is_integral_v<Field>) {
+    if (std::min(a.rows(), a.cols()) >= kModularMinSize) {
+      return Modular::Rank<Field>(a, pool);
+    }
+  }
+  if constexpr (IsIntegralField<Field>::value) {
+    return BareissRank(a, pool);
+  } else {
+    return DivisionRank(a, pool);
+  }
+}
+
+template<typename Field>
+Field DivisionDet(MatrixView<Field> a, ThreadPool* pool) {
+  size_t n = a.rows();
+  Field det = 1;
+  for (size_t cnt = 0; cnt < n; ++cnt) {
+    Field max_el = Abs(a[cnt][cnt]);
+    size_t max_idx = cnt;
+    for (size_t row = cnt + 1; row < n; ++row) {
+      if (max_el < Abs(a[row][cnt])) {
+        max_el = Abs(a[row][cnt]);
+        max_idx = row;
+      }
+    }
+    if (max_el == Field(0)) {
+      return 0;
+    }
+    if (cnt != max_idx) {
+      det *= Field(-1);
+      SwapRows(a, cnt, max_idx, cnt);
+    }
+    det *= a[cnt][cnt];
+    PivotDivisor<Field> divide(a[cnt][cnt]);
+    ForRows<Field>(pool, cnt + 1, n, n - cnt, [&](size_t lo, size_t hi) {
+      for (size_t row = lo; row < hi; ++row) {
+        if (a[row][cnt] == Field(0)) {
+          continue;
+        }
+        Field koef = divide(a[row][cnt]);
+        Kernels::SubScaled(a[row].data() + cnt, a[cnt].data() + cnt, koef, n - cnt);
+      }
+    });
+  }
+  return det;
+}
+
+template<typename Field>
+size_t DivisionRank(MatrixView<Field> a, ThreadPool* pool) {
+  size_t row = 0;
+  size_t col = 0;
+  while (row < a.rows() && col < a.cols()) {
+    size_t idx = row;
+    while (idx < a.rows() && a[idx][col] == Field(0)) {
+      ++idx;
+    }
+    if (idx == a.rows()) {
+      ++col;
+      continue;
+    }
+    if (idx != row) {
+      SwapRows(a, row, idx, col);
+    }
+    PivotDivisor<Field> divide(a[row][col]);
+    ForRows<Field>(pool, row + 1, a.rows(), a.cols() - col, [&](size_t lo, size_t hi) {
+      for (size_t other_row = lo; other_row < hi; ++other_row) {
+        if (a[other_row][col] == Field(0)) {
+          continue;
+        }
+        Field koef = divide(a[other_row][col]);
+        Kernels::SubScaled(a[other_row].data() + col, a[row].data() + col, koef, a.cols() - col);
+      }
+    });
+    ++row;
+    ++col;
+  }
+  return row;
+}
+
+////////////////////////////////Bareiss/////////////////////////////////////////////
+// Built-in integers multiply in a wider type: the quotient fits when the minors do,
+// but the two products before the division may not.
+template<typename Field>
+using Wide = std::conditional_t<std::is_integral_v<Field>,
+                                std::conditional_t<(sizeof(Field) < sizeof(int64_t)), int64_t, __int128>,
+                                Field>;
+
+// row[j] = (row[j] * pivot - lead * pivot_row[j]) / prev for j in [from, to).
+template<typename Field>
+void BareissRow(Field* row, const Field* pivot_row, const Field& pivot, const Field& lead,
+                const Field& prev, size_t from, size_t to) {
+  for (size_t j = from; j < to; ++j) {
+    Wide<Field> value = Wide<Field>(row[j]) * Wide<Field>(pivot) - Wide<Field>(lead) * Wide<Field>(pivot_row[j]);
+    value /= Wide<Field>(prev);
+    row[j] = static_cast<Field>(value);
+  }
+}
+
+// After step k every a[i][j] below the pivots is the (k + 1)-minor on rows 0..k, i and
+// columns 0..k, j, so the division by the previous pivot is always exact.
+template<typename Field>
+Field BareissDet(MatrixView<Field> a, ThreadPool* pool) {
+  size_t n = a.rows();
+  Field prev = 1;
+  bool negate = false;
+  for (size_t k = 0; k < n; ++k) {
+    if (a[k][k] == Field(0)) {
+      size_t idx = k + 1;
+      while (idx < n && a[idx][k] == Field(0)) {
+        ++idx;
+      }
+      if (idx == n) {
+        return 0;
+      }
+      SwapRows(a, k, idx, k);
+      negate = !negate;
+    }
+    ForRows<Field>(pool, k + 1, n, n - k, [&](size_t lo, size_t hi) {
+      for (size_t row = lo; row < hi; ++row) {
+        BareissRow(a[row].data(), a[k].data(), a[k][k], a[row][k], prev, k + 1, n);
+      }
+    });
+    prev = a[k][k];
+  }
+  if (n == 0) {
+    return 1;
+  }
+  Field det = a[n - 1][n - 1];
+  return negate ? Field(0) - det : det;
+}
+
+// The same recurrence with zero columns skipped; the number of pivots is the rank.
+template<typename Field>
+size_t BareissRank(MatrixView<Field> a, ThreadPool* pool) {
+  Field prev = 1;
+  size_t row = 0;
+  for (size_t col = 0; col < a.cols() && row < a.rows(); ++col) {
+    size_t idx = row;
+    while (idx < a.rows() && a[idx][col] == Field(0)) {
+      ++idx;
+    }
+    if (idx == a.rows()) {
+      continue;
+    }
+    if (idx != row) {
+      SwapRows(a, row, idx, col);
+    }
+    ForRows<Field>(pool, row + 1, a.rows(), a.cols() - col, [&](size_t lo, size_t hi) {
+      for (size_t other_row = lo; other_row < hi; ++other_row) {
+        BareissRow(a[other_row].data(), a[row].data(), a[row][col], a[other_row][col], prev, col + 1, a.cols());
+      }
+    });
+    prev = a[row][col];
+    ++row;
+  }
+  return row;
+}
+
+template<typename Field>
+bool Solve(MatrixView<Field> a, MatrixView<Field> e, ThreadPool* pool) {
+  size_t n = a.rows();
+  for (size_t cnt = 0; cnt < n; ++cnt) {
+    size_t max_idx = cnt;
+    for (size_t row = cnt + 1; row < n; ++row) {
+      if (Abs(a[max_idx][cnt]) < Abs(a[row][cnt])) {
+        max_idx = row;
+      }
+    }
+    if (a[max_idx][cnt] == Field(0)) {
+      return false;
+    }
+    if (max_idx != cnt) {
+      SwapRows(a, cnt, max_idx, cnt);
+      SwapRows(e, cnt, max_idx);
+    }
+    PivotDivisor<Field> divide(a[cnt][cnt]);
+    ForRows<Field>(pool, 0, n, n - cnt + e.cols(), [&](size_t lo, size_t hi) {
+      for (size_t other_row = lo; other_row < hi; ++other_row) {
+        if (other_row == cnt || a[other_row][cnt] == Field(0)) {
+          continue;
+        }
+        Field koef = divide(a[other_row][cnt]);
+        Kernels::SubScaled(a[other_row].data() + cnt, a[cnt].data() + cnt, koef, n - cnt);
+        Kernels::SubScaled(e[other_row].data(), e[cnt].data(), koef, e.cols());
+      }
+    });
+  }
+  std::vector<Field> diagonal(n);
+  for (size_t row = 0; row < n; ++row) {
+    diagonal[row] = a[row][row];
+  }
+  if constexpr (std::is_floating_point_v<Field>) {
+    for (Field& value : diagonal) {
+      value = Field(1) / value;
+    }
+  } else {
+    InvertAll(std::span<Field>(diagonal));
+  }
+  ForRows<Field>(pool, 0, n, e.cols(), [&](size_t lo, size_t hi) {
+    for (size_t row = lo; row < hi; ++row) {
+      Kernels::Scale(e[row].data(), diagonal[row], e.cols());
+    }
+  });
+  return true;
+}
+
+template<typename Field>
+void Invert(MatrixView<Field> a, MatrixView<Field> e, ThreadPool* pool) {
+  Solve(a, e, pool);
+}
+
+}
@@ -0,0 +1,91 @@
+#ifndef GAUSS_H_
+#define GAUSS_H_
+
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Gauss///////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Gaussian elimination over strided views, shared by Matrix and DynMatrix.
+// Every routine works in place and leaves the input view in an unspecified state.
+// Given a pool, the row updates below each pivot are split into row blocks and
+// run on its threads; trailing submatrices too small to pay for that stay serial.
+namespace Gauss {
+
+// Fields whose division truncates: built-in integers and any type that specializes
+// std::numeric_limits with is_integer (e.g. BigInteger). det() and rank() eliminate
+// fraction-free (Bareiss) over them, so every intermediate is an exact minor of the
+// input and stays within Hadamard's bound.
+template<typename Field>
+struct IsIntegralField : std::bool_constant<std::numeric_limits<Field>::is_integer> {};
+
+// |value| for built-in numbers, value.abs() for the Field classes.
+template<typename Field>
+Field Abs(const Field& value);
+
+// Swaps rows i and j of the view starting from column from.
+template<typename Field>
+void SwapRows(MatrixView<Field> a, size_t i, size_t j, size_t from = 0);
+
+// Per-thread state that arithmetic of Field depends on, such as the modulus of
+// DynResidue. ForRows installs Current() of the calling thread in the pool's threads
+// with a Scope for the duration of the loop. Stateless Fields keep this default.
+template<typename Field>
+struct FieldContext {
+  struct Scope {
+    explicit Scope(std::nullptr_t) {}
+  };
+  static std::nullptr_t Current() { return nullptr; }
+};
+
+// Runs body(lo, hi) over rows [begin, end) of width elements each, split into
+// parallel blocks when there is a pool and enough work to pay for waking it.
+template<typename Field, typename Body>
+void ForRows(ThreadPool* pool, size_t begin, size_t end, size_t width, Body&& body);
+
+// Replaces every value by its inverse at the cost of one division (Montgomery's trick):
+// prefix products forwards, one inversion of their total, then back. Values are nonzero.
+template<typename Field>
+void InvertAll(std::span<Field> values);
+
+// Built-in integers from kModularMinSize rows on go through Modular, other integral
+// Fields through Bareiss and everything else through DivisionDet/DivisionRank.
+template<typename Field>
+Field Det(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+template<typename Field>
+size_t Rank(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+// Partial pivoting with division, for fields proper.
+template<typename Field>
+Field DivisionDet(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+template<typename Field>
+size_t DivisionRank(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+template<typename Field>
+Field BareissDet(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+template<typename Field>
+size_t BareissRank(MatrixView<Field> a, ThreadPool* pool = nullptr);
+
+// Gauss-Jordan elimination that turns e into a^-1 * e, i.e. solves a x = e for every
+// column of e at once. Returns false, with e unspecified, when a is singular.
+template<typename Field>
+bool Solve(MatrixView<Field> a, MatrixView<Field> e, ThreadPool* pool = nullptr);
+
+// Solve for a nonsingular a (e is the identity for a plain inversion).
+template<typename Field>
+void Invert(MatrixView<Field> a, MatrixView<Field> e, ThreadPool* pool = nullptr);
+
+}
+
+#endif //GAUSS_H_
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "Gemm.h"
+
+#include <bit>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Kernels.cpp"
+
+namespace Gemm {
+
+////////////////////////////////Packing/////////////////////////////////////////////
+// Lays an mc x kc block of A out as MR-row slivers, column after column, so the
+// micro-kernel reads it sequentially. Missing rows of the last sliver are zeros.
+template<typename Field>
+void PackA(MatrixView<const Field> a, Field* dst) {
+  constexpr size_t kMR = Blocking<Field>::kMR;
+  for (size_t row = 0; row < a.rows(); row += kMR) {
+    size_t height = std::min(kMR, a.rows() - row);
+    for (size_t k = 0; k < a.cols(); ++k) {
+      for (size_t r = 0; r < kMR; ++r) {
+        *dst++ = (r < height) ? a.data()[(row + r) * a.stride() + k] : Field(0);
+      }
+    }
+  }
+}
+
+// Lays a kc x nc panel of B out as NR-column slivers, row after row.
+template<typename Field>
+void PackB(MatrixView<const Field> b, Field* dst) {
+  constexpr size_t kNR = Blocking<Field>::kNR;
+  for (size_t col = 0; col < b.cols(); col += kNR) {
+    size_t width = std::min(kNR, b.cols() - col);
+    for (size_t k = 0; k < b.rows(); ++k) {
+      const Field* src = b.data() + k * b.stride() + col;
+      for (size_t c = 0; c < kNR; ++c) {
+        *dst++ = (c < width) ? src[c] : Field(0);
+      }
+    }
+  }
+}
+
+////////////////////////////////Micro-kernel////////////////////////////////////////
+// Accumulates an MR x NR tile of C in registers over the whole kc depth and
+// writes only its height x width valid part back.
+template<typename Field>
+void MicroKernel(size_t kc, const Field* pa, const Field* pb, Field* c, size_t ldc,
+                 size_t height, size_t width) {
+  constexpr size_t kMR = Blocking<Field>::kMR;
+  constexpr size_t kNR = Blocking<Field>::kNR;
+  Field acc[kMR][kNR]{};
+  for (size_t k = 0; k < kc; ++k) {
+    for (size_t r = 0; r < kMR; ++r) {
+      Field koef = pa[r];
+      for (size_t col = 0; col < kNR; ++col) {
+        acc[r][col] += koef * pb[col];
+      }
+    }
+    pa += kMR;
+    pb += kNR;
+  }
+  for (size_t r = 0; r < height; ++r) {
+    for (size_t col = 0; col < width; ++col) {
+      c[r * ldc + col] += acc[r][col];
+    }
+  }
+}
+
+////////////////////////////////Multiplication//////////////////////////////////////
+template<typename Field>
+void MultiplyNaive(MatrixView<const Field> a, MatrixView<const Field> b, MatrixView<Field> c) {
+  for (size_t row = 0; row < a.rows(); ++row) {
+    for (size_t in = 0; in < a.cols(); ++in) {
+      const Field& koef = a[row][in];
+      for (size_t col = 0; col < b.cols(); ++col) {
+        c[row][col] += koef * b[in][col];
+      }
+    }
+  }
+}
+
+template<typename Field>
+void MultiplyClassical(MatrixView<const Field> a, MatrixView<const Field> b, MatrixView<Field> c) {
+  using B = Blocking<Field>;
+  const size_t kSmall = 32;
+  if constexpr (!kPackable<Field>) {
+    MultiplyNaive(a, b, c);
+  } else {
+    if (a.rows() < kSmall && a.cols() < kSmall && b.cols() < kSmall) {
+      MultiplyNaive(a, b, c);
+      return;
+    }
+    std::vector<Field> packed_a(B::kMC * B::kKC);
+    std::vector<Field> packed_b(B::kKC * ((std::min(B::kNC, b.cols()) + B::kNR - 1) / B::kNR * B::kNR));
+    for (size_t jc = 0; jc < b.cols(); jc += B::kNC) {
+      size_t nc = std::min(B::kNC, b.cols() - jc);
+      for (size_t pc = 0; pc < a.cols(); pc += B::kKC) {
+        size_t kc = std::min(B::kKC, a.cols() - pc);
+        PackB(b.block(pc, jc, kc, nc), packed_b.data());
+        for (size_t ic = 0; ic < a.rows(); ic += B::kMC) {
+          size_t mc = std::min(B::kMC, a.rows() - ic);
+          PackA(a.block(ic, pc, mc, kc), packed_a.data());
+          for (size_t jr = 0; jr < nc; jr += B::kNR) {
+            for (size_t ir = 0; ir < mc; ir += B::kMR) {
+              MicroKernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc,
+                          c.data() + (ic + ir) * c.stride() + jc + jr, c.stride(),
+                          std::min(B::kMR, mc - ir), std::min(B::kNR, nc - jr));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////Strassen-Winograd/////////////////////////////////
+// dst = x + y, or x - y when subtract is set.
+template<typename Field>
+void Combine(MatrixView<Field> dst, MatrixView<const Field> x, MatrixView<const Field> y, bool subtract) {
+  for (size_t row = 0; row < dst.rows(); ++row) {
+    std::copy(x[row].begin(), x[row].end(), dst[row].begin());
+    if (subtract) {
+      Kernels::Sub(dst[row].data(), y[row].data(), dst.cols());
+    } else {
+      Kernels::Add(dst[row].data(), y[row].data(), dst.cols());
+    }
+  }
+}
+
+// dst += x, or dst -= x when subtract is set.
+template<typename Field>
+void Accumulate(MatrixView<Field> dst, MatrixView<const Field> x, bool subtract) {
+  for (size_t row = 0; row < dst.rows(); ++row) {
+    if (subtract) {
+      Kernels::Sub(dst[row].data(), x[row].data(), dst.cols());
+    } else {
+      Kernels::Add(dst[row].data(), x[row].data(), dst.cols());
+    }
+  }
+}
+
+// c += a * b over the even part of every dimension with Winograd's form of Strassen:
+//   S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2,
+//   T1 = B12 - B11, T2 = B22 - T1, T3 = B22 - B12, T4 = T2 - B21,
+//   U2 = A11 B11 + S2 T2, U3 = U2 + S3 T3,
+//   C11 = A11 B11 + A12 B21, C12 = U2 + S1 T1 + S4 B22,
+//   C21 = U3 - A22 T4,      C22 = U3 + S1 T1.
+// The seven products go back through MultiplyAdd; an odd last row, column or inner
+// index is peeled off into thin classical products.
+template<typename Field>
+void Winograd(MatrixView<const Field> a, MatrixView<const Field> b, MatrixView<Field> c) {
+  size_t m = a.rows() / 2;
+  size_t k = a.cols() / 2;
+  size_t n = b.cols() / 2;
+  MatrixView<const Field> a11 = a.block(0, 0, m, k), a12 = a.block(0, k, m, k);
+  MatrixView<const Field> a21 = a.block(m, 0, m, k), a22 = a.block(m, k, m, k);
+  MatrixView<const Field> b11 = b.block(0, 0, k, n), b12 = b.block(0, n, k, n);
+  MatrixView<const Field> b21 = b.block(k, 0, k, n), b22 = b.block(k, n, k, n);
+  MatrixView<Field> c11 = c.block(0, 0, m, n), c12 = c.block(0, n, m, n);
+  MatrixView<Field> c21 = c.block(m, 0, m, n), c22 = c.block(m, n, m, n);
+
+  // Two m x n accumulators, two m x k and two k x n operands, reused as they free up.
+  std::vector<Field> buffer(2 * m * n + 2 * m * k + 2 * k * n);
+  Field* next = buffer.data();
+  auto take = [&next](size_t rows, size_t cols) {
+    MatrixView<Field> view(next, rows, cols, cols);
+    next += rows * cols;
+    return view;
+  };
+  MatrixView<Field> u = take(m, n), p = take(m, n);
+  MatrixView<Field> s = take(m, k), s2 = take(m, k);
+  MatrixView<Field> t = take(k, n), t2 = take(k, n);
+
+  Combine<Field>(s, a21, a22, false);  // S1
+  Combine<Field>(s2, s, a11, true);
+  Combine<Field>(t, b12, b11, true);   // T1
+  Combine<Field>(t2, b22, t, true);
+  MultiplyAdd<Field>(a11, b11, u);
+  Accumulate<Field>(c11, u, false);
+  MultiplyAdd<Field>(a12, b21, c11);
+  MultiplyAdd<Field>(s2, t2, u);       // U2
+  MultiplyAdd<Field>(s, t, p);         // S1 T1
+  Combine<Field>(s, a12, s2, true);    // S4
+  Combine<Field>(t, t2, b21, true);    // T4
+  Combine<Field>(s2, a11, a21, true);  // S3
+  Combine<Field>(t2, b22, b12, true);  // T3
+  Accumulate<Field>(c12, u, false);
+  Accumulate<Field>(c12, p, false);
+  MultiplyAdd<Field>(s, b22, c12);
+  MultiplyAdd<Field>(s2, t2, u);       // U3
+  Accumulate<Field>(c22, u, false);
+  Accumulate<Field>(c22, p, false);
+  Accumulate<Field>(c21, u, false);
+  for (size_t row = 0; row < m; ++row) {
+    std::fill(p[row].begin(), p[row].end(), Field(0));
+  }
+  MultiplyAdd<Field>(a22, t, p);       // A22 T4
+  Accumulate<Field>(c21, p, true);
+
+  size_t even_rows = 2 * m;
+  size_t even_inner = 2 * k;
+  size_t even_cols = 2 * n;
+  if (even_inner != a.cols()) {
+    MultiplyAdd<Field>(a.block(0, even_inner, even_rows, 1), b.block(even_inner, 0, 1, even_cols),
+                       c.block(0, 0, even_rows, even_cols));
+  }
+  if (even_cols != b.cols()) {
+    MultiplyAdd<Field>(a.block(0, 0, even_rows, a.cols()), b.block(0, even_cols, b.rows(), 1),
+                       c.block(0, even_cols, even_rows, 1));
+  }
+  if (even_rows != a.rows()) {
+    MultiplyAdd<Field>(a.block(even_rows, 0, 1, a.cols()), b, c.block(even_rows, 0, 1, b.cols()));
+  }
+}
+
+template<typename Field>
+void MultiplyAdd(MatrixView<const Field> a, MatrixView<const Field> b, MatrixView<Field> c) {
+  size_t crossover = StrassenCrossover<Field>::value;
+  if (crossover != 0 && std::min({a.rows(), a.cols(), b.cols()}) >= std::max<size_t>(crossover, 2)) {
+    Winograd(a, b, c);
+  } else {
+    MultiplyClassical(a, b, c);
+  }
+}
+
+template<typename Field>
+void MultiplyInPlace(MatrixView<Field> a, MatrixView<const Field> b) {
+  size_t n = b.cols();
+  const Field* a_end = a.data() + (a.rows() == 0 ? 0 : (a.rows() - 1) * a.stride() + a.cols());
+  const Field* b_end = b.data() + (b.rows() == 0 ? 0 : (b.rows() - 1) * b.stride() + b.cols());
+  std::vector<Field> b_copy;
+  if (std::less<const Field*>()(b.data(), a_end) && std::less<const Field*>()(a.data(), b_end)) {
+    b_copy.resize(n * n);
+    for (size_t row = 0; row < n; ++row) {
+      std::copy(b[row].begin(), b[row].end(), b_copy.begin() + row * n);
+    }
+    b = {b_copy.data(), n, n, n};
+  }
+  size_t block_rows = std::min(Blocking<Field>::kMC, a.rows());
+  std::vector<Field> buffer(block_rows * n);
+  for (size_t row = 0; row < a.rows(); row += block_rows) {
+    size_t height = std::min(block_rows, a.rows() - row);
+    for (size_t r = 0; r < height; ++r) {
+      std::copy(a[row + r].begin(), a[row + r].end(), buffer.begin() + r * n);
+      std::fill(a[row + r].begin(), a[row + r].end(), Field(0));
+    }
+    MultiplyAdd<Field>({buffer.data(), height, n, n}, b, a.block(row, 0, height, n));
+  }
+}
+
+////////////////////////////////Powers//////////////////////////////////////////////
+template<typename Field>
+void Power(MatrixView<const Field> a, uint64_t k, MatrixView<Field> result, MatrixView<Field> scratch) {
+  size_t n = a.rows();
+  if (k == 0) {
+    for (size_t row = 0; row < n; ++row) {
+      std::fill(result[row].begin(), result[row].end(), Field(0));
+      result[row][row] = 1;
+    }
+    return;
+  }
+  MatrixView<Field> current = result;
+  MatrixView<Field> next = scratch;
+  for (size_t row = 0; row < n; ++row) {
+    std::copy(a[row].begin(), a[row].end(), current[row].begin());
+  }
+  // The leading bit of k is the copy of a itself.
+  for (int bit = std::bit_width(k) - 2; bit >= 0; --bit) {
+    for (size_t row = 0; row < n; ++row) {
+      std::fill(next[row].begin(), next[row].end(), Field(0));
+    }
+    MultiplyAdd<Field>(current, current, next);
+    std::swap(current, next);
+    if ((k >> bit) & 1) {
+      for (size_t row = 0; row < n; ++row) {
+        std::fill(next[row].begin(), next[row].end(), Field(0));
+      }
+      MultiplyAdd<Field>(current, a, next);
+      std::swap(current, next);
+    }
+  }
+  if (current.data() != result.data()) {
+    for (size_t row = 0; row < n; ++row) {
+      std::copy(current[row].begin(), current[row].end(), result[row].begin());
+    }
+  }
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "MatrixView.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Gemm////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Cache-blocked matrix multiplication shared by Matrix and DynMatrix.
+namespace Gemm {
+
+// Tile sizes: an MR x NR block of C lives in registers, a KC x NR sliver of B in L1,
+// an MC x KC block of A in L2 and a KC x NC panel of B in L3.
+template<typename Field>
+struct Blocking {
+  static constexpr size_t kMR = 4;
+  static constexpr size_t kNR = std::clamp<size_t>(64 / sizeof(Field), 4, 16);
+  static constexpr size_t kKC = 256;
+  static constexpr size_t kMC = 128;
+  static constexpr size_t kNC = 2048;
+};
+
+// Fields that can be copied into packed panels as plain memory; the rest
+// (BigInteger, Rational) go through a straightforward row-by-row loop.
+template<typename Field>
+inline constexpr bool kPackable = std::is_trivially_copyable_v<Field>;
+
+// Order from which MultiplyAdd recurses with Strassen-Winograd (7 half-size products
+// and 15 additions instead of 8 products) rather than running the classical kernel
+// on the whole product; 0 never recurses. It pays where a scalar product costs much
+// more than a sum. Built-in numbers stay classical: their products are cheap, error
+// grows with every level for floating point, and the intermediate sums of integers
+// can overflow where the classical order does not. Field types specialize this.
+template<typename Field>
+struct StrassenCrossover {
+  static constexpr size_t value = std::is_arithmetic_v<Field> ? 0 : 32;
+};
+
+// c += a * b.
+template<typename Field>
+void MultiplyAdd(MatrixView<const Field> a, MatrixView<const Field> b, MatrixView<Field> c);
+
+// a = a * b for a square b, buffering only one block of rows of a at a time.
+template<typename Field>
+void MultiplyInPlace(MatrixView<Field> a, MatrixView<const Field> b);
+
+// result = a^k for a square a by left-to-right binary powering, O(n^3 log k).
+// Every squaring and every multiplication by a writes into whichever of result and
+// scratch does not hold the current power, so no step allocates a matrix.
+template<typename Field>
+void Power(MatrixView<const Field> a, uint64_t k, MatrixView<Field> result, MatrixView<Field> scratch);
+
+}
+
+#endif //GEMM_H_
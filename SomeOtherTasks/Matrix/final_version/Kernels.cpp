@@ -0,0 +1,507 @@
+#pragma once
+
+#include "Kernels.h"
+
+#include <cstdint>
+#include <type_traits>
+
+#include "DynResidue.h"
+#include "FastResidue.h"
+#include "Matrix.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Kernels {
+
+enum Op { kAdd, kSub, kScale, kSubScaled, kAddScaled };
+
+// Residue<N> is a single size_t, so a row of residues is a row of words. Products
+// of two residues below 2^26 are exact in a double, which the vector modmul needs.
+const uint64_t kMaxSimdModulus = uint64_t(1) << 26;
+
+template<size_t N>
+uint64_t* Words(Residue<N>* r) {
+  static_assert(std::is_standard_layout_v<Residue<N>> && sizeof(Residue<N>) == sizeof(uint64_t));
+  return reinterpret_cast<uint64_t*>(r);
+}
+template<size_t N>
+const uint64_t* Words(const Residue<N>* r) {
+  static_assert(std::is_standard_layout_v<Residue<N>> && sizeof(Residue<N>) == sizeof(uint64_t));
+  return reinterpret_cast<const uint64_t*>(r);
+}
+
+// FastResidue<N> for 2^16 < N < 2^31 is a single uint32_t. With koef fixed for the
+// whole row, koef * x mod N is Shoup's multiplication: the quotient is the high half
+// of x * floor(koef * 2^32 / N) and misses by at most one, so both the remainder
+// and every sum or difference of residues fit in 32 bits before one correction.
+const uint64_t kMaxShoupModulus = uint64_t(1) << 31;
+
+template<size_t N>
+typename FastResidue<N>::Storage* Words(FastResidue<N>* r) {
+  static_assert(std::is_standard_layout_v<FastResidue<N>> && sizeof(FastResidue<N>) == sizeof(typename FastResidue<N>::Storage));
+  return reinterpret_cast<typename FastResidue<N>::Storage*>(r);
+}
+template<size_t N>
+const typename FastResidue<N>::Storage* Words(const FastResidue<N>* r) {
+  static_assert(std::is_standard_layout_v<FastResidue<N>> && sizeof(FastResidue<N>) == sizeof(typename FastResidue<N>::Storage));
+  return reinterpret_cast<const typename FastResidue<N>::Storage*>(r);
+}
+
+// DynResidue is a single uint32_t too, with the modulus known only at run time.
+inline uint32_t* Words(DynResidue* r) {
+  static_assert(std::is_standard_layout_v<DynResidue> && sizeof(DynResidue) == sizeof(uint32_t));
+  return reinterpret_cast<uint32_t*>(r);
+}
+inline const uint32_t* Words(const DynResidue* r) {
+  static_assert(std::is_standard_layout_v<DynResidue> && sizeof(DynResidue) == sizeof(uint32_t));
+  return reinterpret_cast<const uint32_t*>(r);
+}
+
+#ifdef MATRIX_SIMD_KERNELS
+
+enum class Isa { kScalar, kAvx2, kAvx512 };
+
+inline Isa CpuIsa() {
+  static const Isa isa = __builtin_cpu_supports("avx512f") ? Isa::kAvx512
+                         : __builtin_cpu_supports("avx2")  ? Isa::kAvx2
+                                                           : Isa::kScalar;
+  return isa;
+}
+
+////////////////////////////////AVX2 kernels////////////////////////////////////////
+
+// Low 64 bits of a 64x64 product from three 32x32->64 multiplies.
+inline __attribute__((target("avx2"))) __m256i MulLoAvx2(__m256i a, __m256i b) {
+  __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                   _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+  return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+// a * b mod m for a, b < m <= 2^26: the quotient is estimated in doubles (exact up
+// to one unit either way) and the remainder corrected with two conditional steps.
+inline __attribute__((target("avx2"))) __m256i ModMulAvx2(__m256i a, __m256i b, __m256i mod, __m256d inv) {
+  const __m256i magic_bits = _mm256_set1_epi64x(0x4330000000000000);
+  const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+  __m256i product = _mm256_mul_epu32(a, b);
+  __m256d exact = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(product, magic_bits)), magic);
+  __m256d quotient = _mm256_add_pd(_mm256_floor_pd(_mm256_mul_pd(exact, inv)), magic);
+  __m256i q = _mm256_xor_si256(_mm256_castpd_si256(quotient), magic_bits);
+  __m256i r = _mm256_sub_epi64(product, _mm256_mul_epu32(q, mod));
+  r = _mm256_add_epi64(r, _mm256_and_si256(_mm256_cmpgt_epi64(_mm256_setzero_si256(), r), mod));
+  __m256i top = _mm256_sub_epi64(mod, _mm256_set1_epi64x(1));
+  return _mm256_sub_epi64(r, _mm256_and_si256(_mm256_cmpgt_epi64(r, top), mod));
+}
+
+template<int Op>
+__attribute__((target("avx2"))) size_t DoubleAvx2(double* dst, const double* src, double koef, size_t count) {
+  const __m256d k = _mm256_set1_pd(koef);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d d = _mm256_loadu_pd(dst + i);
+    if constexpr (Op == kScale) {
+      d = _mm256_mul_pd(d, k);
+    } else {
+      __m256d s = _mm256_loadu_pd(src + i);
+      if constexpr (Op == kAdd) {
+        d = _mm256_add_pd(d, s);
+      } else if constexpr (Op == kSub) {
+        d = _mm256_sub_pd(d, s);
+      } else if constexpr (Op == kAddScaled) {
+        d = _mm256_add_pd(d, _mm256_mul_pd(k, s));
+      } else {
+        d = _mm256_sub_pd(d, _mm256_mul_pd(k, s));
+      }
+    }
+    _mm256_storeu_pd(dst + i, d);
+  }
+  return i;
+}
+
+template<int Op>
+__attribute__((target("avx2"))) size_t Int64Avx2(int64_t* dst, const int64_t* src, int64_t koef, size_t count) {
+  const __m256i k = _mm256_set1_epi64x(koef);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m256i*>(dst + i);
+    __m256i d = _mm256_loadu_si256(ptr);
+    if constexpr (Op == kScale) {
+      d = MulLoAvx2(d, k);
+    } else {
+      __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      if constexpr (Op == kAdd) {
+        d = _mm256_add_epi64(d, s);
+      } else if constexpr (Op == kSub) {
+        d = _mm256_sub_epi64(d, s);
+      } else if constexpr (Op == kAddScaled) {
+        d = _mm256_add_epi64(d, MulLoAvx2(k, s));
+      } else {
+        d = _mm256_sub_epi64(d, MulLoAvx2(k, s));
+      }
+    }
+    _mm256_storeu_si256(ptr, d);
+  }
+  return i;
+}
+
+template<int Op>
+__attribute__((target("avx2"))) size_t ResidueAvx2(uint64_t* dst, const uint64_t* src, uint64_t koef,
+                                                   uint64_t modulus, size_t count) {
+  const __m256i k = _mm256_set1_epi64x(static_cast<int64_t>(koef));
+  const __m256i mod = _mm256_set1_epi64x(static_cast<int64_t>(modulus));
+  const __m256i top = _mm256_set1_epi64x(static_cast<int64_t>(modulus - 1));
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256d inv = _mm256_set1_pd(1.0 / static_cast<double>(modulus));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m256i*>(dst + i);
+    __m256i d = _mm256_loadu_si256(ptr);
+    if constexpr (Op == kScale) {
+      d = ModMulAvx2(d, k, mod, inv);
+    } else {
+      __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      if constexpr (Op == kAdd || Op == kAddScaled) {
+        if constexpr (Op == kAddScaled) {
+          s = ModMulAvx2(s, k, mod, inv);
+        }
+        d = _mm256_add_epi64(d, s);
+        d = _mm256_sub_epi64(d, _mm256_and_si256(_mm256_cmpgt_epi64(d, top), mod));
+      } else {
+        if constexpr (Op == kSubScaled) {
+          s = ModMulAvx2(s, k, mod, inv);
+        }
+        d = _mm256_sub_epi64(d, s);
+        d = _mm256_add_epi64(d, _mm256_and_si256(_mm256_cmpgt_epi64(zero, d), mod));
+      }
+    }
+    _mm256_storeu_si256(ptr, d);
+  }
+  return i;
+}
+
+// koef * x mod m for x < m < 2^31 in 32-bit lanes, shoup = floor(koef * 2^32 / m).
+inline __attribute__((target("avx2"))) __m256i ShoupMulAvx2(__m256i x, __m256i koef, __m256i shoup, __m256i mod) {
+  __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, shoup), 32);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), shoup);
+  __m256i q = _mm256_blend_epi32(even, odd, 0b10101010);
+  __m256i r = _mm256_sub_epi32(_mm256_mullo_epi32(x, koef), _mm256_mullo_epi32(q, mod));
+  return _mm256_min_epu32(r, _mm256_sub_epi32(r, mod));
+}
+
+template<int Op>
+__attribute__((target("avx2"))) size_t ShoupAvx2(uint32_t* dst, const uint32_t* src, uint32_t koef,
+                                                 uint32_t modulus, size_t count) {
+  const __m256i k = _mm256_set1_epi32(static_cast<int>(koef));
+  const __m256i shoup = _mm256_set1_epi32(static_cast<int>((uint64_t(koef) << 32) / modulus));
+  const __m256i mod = _mm256_set1_epi32(static_cast<int>(modulus));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto* ptr = reinterpret_cast<__m256i*>(dst + i);
+    __m256i d = _mm256_loadu_si256(ptr);
+    if constexpr (Op == kScale) {
+      d = ShoupMulAvx2(d, k, shoup, mod);
+    } else {
+      __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      if constexpr (Op == kAdd || Op == kAddScaled) {
+        if constexpr (Op == kAddScaled) {
+          s = ShoupMulAvx2(s, k, shoup, mod);
+        }
+        d = _mm256_add_epi32(d, s);
+        d = _mm256_min_epu32(d, _mm256_sub_epi32(d, mod));
+      } else {
+        if constexpr (Op == kSubScaled) {
+          s = ShoupMulAvx2(s, k, shoup, mod);
+        }
+        d = _mm256_sub_epi32(d, s);
+        d = _mm256_min_epu32(d, _mm256_add_epi32(d, mod));
+      }
+    }
+    _mm256_storeu_si256(ptr, d);
+  }
+  return i;
+}
+
+////////////////////////////////AVX-512 kernels/////////////////////////////////////
+
+// GCC 12 warns that __Y in its own avx512fintrin.h may be used uninitialized here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+inline __attribute__((target("avx512f"))) __m512i MulLoAvx512(__m512i a, __m512i b) {
+  __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), b),
+                                   _mm512_mul_epu32(a, _mm512_srli_epi64(b, 32)));
+  return _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32));
+}
+
+inline __attribute__((target("avx512f"))) __m512i ModMulAvx512(__m512i a, __m512i b, __m512i mod, __m512d inv) {
+  const __m512i magic_bits = _mm512_set1_epi64(0x4330000000000000);
+  const __m512d magic = _mm512_set1_pd(4503599627370496.0);
+  __m512i product = _mm512_mul_epu32(a, b);
+  __m512d exact = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(product, magic_bits)), magic);
+  __m512d floor = _mm512_roundscale_pd(_mm512_mul_pd(exact, inv), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  __m512i q = _mm512_xor_si512(_mm512_castpd_si512(_mm512_add_pd(floor, magic)), magic_bits);
+  __m512i r = _mm512_sub_epi64(product, _mm512_mul_epu32(q, mod));
+  r = _mm512_mask_add_epi64(r, _mm512_cmplt_epi64_mask(r, _mm512_setzero_si512()), r, mod);
+  return _mm512_mask_sub_epi64(r, _mm512_cmpge_epi64_mask(r, mod), r, mod);
+}
+
+template<int Op>
+__attribute__((target("avx512f"))) size_t DoubleAvx512(double* dst, const double* src, double koef, size_t count) {
+  const __m512d k = _mm512_set1_pd(koef);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m512d d = _mm512_loadu_pd(dst + i);
+    if constexpr (Op == kScale) {
+      d = _mm512_mul_pd(d, k);
+    } else {
+      __m512d s = _mm512_loadu_pd(src + i);
+      if constexpr (Op == kAdd) {
+        d = _mm512_add_pd(d, s);
+      } else if constexpr (Op == kSub) {
+        d = _mm512_sub_pd(d, s);
+      } else if constexpr (Op == kAddScaled) {
+        d = _mm512_add_pd(d, _mm512_mul_pd(k, s));
+      } else {
+        d = _mm512_sub_pd(d, _mm512_mul_pd(k, s));
+      }
+    }
+    _mm512_storeu_pd(dst + i, d);
+  }
+  return i;
+}
+
+template<int Op>
+__attribute__((target("avx512f"))) size_t Int64Avx512(int64_t* dst, const int64_t* src, int64_t koef, size_t count) {
+  const __m512i k = _mm512_set1_epi64(koef);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m512i d = _mm512_loadu_si512(dst + i);
+    if constexpr (Op == kScale) {
+      d = MulLoAvx512(d, k);
+    } else {
+      __m512i s = _mm512_loadu_si512(src + i);
+      if constexpr (Op == kAdd) {
+        d = _mm512_add_epi64(d, s);
+      } else if constexpr (Op == kSub) {
+        d = _mm512_sub_epi64(d, s);
+      } else if constexpr (Op == kAddScaled) {
+        d = _mm512_add_epi64(d, MulLoAvx512(k, s));
+      } else {
+        d = _mm512_sub_epi64(d, MulLoAvx512(k, s));
+      }
+    }
+    _mm512_storeu_si512(dst + i, d);
+  }
+  return i;
+}
+
+template<int Op>
+__attribute__((target("avx512f"))) size_t ResidueAvx512(uint64_t* dst, const uint64_t* src, uint64_t koef,
+                                                        uint64_t modulus, size_t count) {
+  const __m512i k = _mm512_set1_epi64(static_cast<int64_t>(koef));
+  const __m512i mod = _mm512_set1_epi64(static_cast<int64_t>(modulus));
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512d inv = _mm512_set1_pd(1.0 / static_cast<double>(modulus));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m512i d = _mm512_loadu_si512(dst + i);
+    if constexpr (Op == kScale) {
+      d = ModMulAvx512(d, k, mod, inv);
+    } else {
+      __m512i s = _mm512_loadu_si512(src + i);
+      if constexpr (Op == kAdd || Op == kAddScaled) {
+        if constexpr (Op == kAddScaled) {
+          s = ModMulAvx512(s, k, mod, inv);
+        }
+        d = _mm512_add_epi64(d, s);
+        d = _mm512_mask_sub_epi64(d, _mm512_cmpge_epi64_mask(d, mod), d, mod);
+      } else {
+        if constexpr (Op == kSubScaled) {
+          s = ModMulAvx512(s, k, mod, inv);
+        }
+        d = _mm512_sub_epi64(d, s);
+        d = _mm512_mask_add_epi64(d, _mm512_cmplt_epi64_mask(d, zero), d, mod);
+      }
+    }
+    _mm512_storeu_si512(dst + i, d);
+  }
+  return i;
+}
+
+inline __attribute__((target("avx512f"))) __m512i ShoupMulAvx512(__m512i x, __m512i koef, __m512i shoup, __m512i mod) {
+  __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(x, shoup), 32);
+  __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), shoup);
+  __m512i q = _mm512_mask_blend_epi32(0xAAAA, even, odd);
+  __m512i r = _mm512_sub_epi32(_mm512_mullo_epi32(x, koef), _mm512_mullo_epi32(q, mod));
+  return _mm512_min_epu32(r, _mm512_sub_epi32(r, mod));
+}
+
+template<int Op>
+__attribute__((target("avx512f"))) size_t ShoupAvx512(uint32_t* dst, const uint32_t* src, uint32_t koef,
+                                                      uint32_t modulus, size_t count) {
+  const __m512i k = _mm512_set1_epi32(static_cast<int>(koef));
+  const __m512i shoup = _mm512_set1_epi32(static_cast<int>((uint64_t(koef) << 32) / modulus));
+  const __m512i mod = _mm512_set1_epi32(static_cast<int>(modulus));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512i d = _mm512_loadu_si512(dst + i);
+    if constexpr (Op == kScale) {
+      d = ShoupMulAvx512(d, k, shoup, mod);
+    } else {
+      __m512i s = _mm512_loadu_si512(src + i);
+      if constexpr (Op == kAdd || Op == kAddScaled) {
+        if constexpr (Op == kAddScaled) {
+          s = ShoupMulAvx512(s, k, shoup, mod);
+        }
+        d = _mm512_add_epi32(d, s);
+        d = _mm512_min_epu32(d, _mm512_sub_epi32(d, mod));
+      } else {
+        if constexpr (Op == kSubScaled) {
+          s = ShoupMulAvx512(s, k, shoup, mod);
+        }
+        d = _mm512_sub_epi32(d, s);
+        d = _mm512_min_epu32(d, _mm512_add_epi32(d, mod));
+      }
+    }
+    _mm512_storeu_si512(dst + i, d);
+  }
+  return i;
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+////////////////////////////////Dispatch////////////////////////////////////////////
+
+// Each overload handles as many leading elements as it can and returns how many.
+template<int Op, typename Field>
+size_t Vectorized(Field*, const Field*, const Field&, size_t) {
+  return 0;
+}
+
+template<int Op>
+size_t Vectorized(double* dst, const double* src, const double& koef, size_t count) {
+#ifdef MATRIX_SIMD_KERNELS
+  if (CpuIsa() == Isa::kAvx512) {
+    return DoubleAvx512<Op>(dst, src, koef, count);
+  }
+  if (CpuIsa() == Isa::kAvx2) {
+    return DoubleAvx2<Op>(dst, src, koef, count);
+  }
+#endif
+  return 0;
+}
+
+template<int Op>
+size_t Vectorized(int64_t* dst, const int64_t* src, const int64_t& koef, size_t count) {
+#ifdef MATRIX_SIMD_KERNELS
+  if (CpuIsa() == Isa::kAvx512) {
+    return Int64Avx512<Op>(dst, src, koef, count);
+  }
+  if (CpuIsa() == Isa::kAvx2) {
+    return Int64Avx2<Op>(dst, src, koef, count);
+  }
+#endif
+  return 0;
+}
+
+template<int Op, size_t N>
+size_t Vectorized(Residue<N>* dst, const Residue<N>* src, const Residue<N>& koef, size_t count) {
+  if constexpr (N > kMaxSimdModulus) {
+    return 0;
+  } else {
+#ifdef MATRIX_SIMD_KERNELS
+    const uint64_t* from = (src == nullptr) ? nullptr : Words(src);
+    if (CpuIsa() == Isa::kAvx512) {
+      return ResidueAvx512<Op>(Words(dst), from, *Words(&koef), N, count);
+    }
+    if (CpuIsa() == Isa::kAvx2) {
+      return ResidueAvx2<Op>(Words(dst), from, *Words(&koef), N, count);
+    }
+#endif
+    return 0;
+  }
+}
+
+template<int Op, size_t N>
+size_t Vectorized(FastResidue<N>* dst, const FastResidue<N>* src, const FastResidue<N>& koef, size_t count) {
+  if constexpr (!std::is_same_v<typename FastResidue<N>::Storage, uint32_t> || N >= kMaxShoupModulus) {
+    return 0;
+  } else {
+#ifdef MATRIX_SIMD_KERNELS
+    const uint32_t* from = (src == nullptr) ? nullptr : Words(src);
+    if (CpuIsa() == Isa::kAvx512) {
+      return ShoupAvx512<Op>(Words(dst), from, *Words(&koef), N, count);
+    }
+    if (CpuIsa() == Isa::kAvx2) {
+      return ShoupAvx2<Op>(Words(dst), from, *Words(&koef), N, count);
+    }
+#endif
+    return 0;
+  }
+}
+
+template<int Op>
+size_t Vectorized(DynResidue* dst, const DynResidue* src, const DynResidue& koef, size_t count) {
+#ifdef MATRIX_SIMD_KERNELS
+  uint32_t modulus = ModulusScope::Required().modulus();
+  if (modulus < kMaxShoupModulus) {
+    const uint32_t* from = (src == nullptr) ? nullptr : Words(src);
+    if (CpuIsa() == Isa::kAvx512) {
+      return ShoupAvx512<Op>(Words(dst), from, *Words(&koef), modulus, count);
+    }
+    if (CpuIsa() == Isa::kAvx2) {
+      return ShoupAvx2<Op>(Words(dst), from, *Words(&koef), modulus, count);
+    }
+  }
+#endif
+  return 0;
+}
+
+template<int Op, typename Field>
+void Apply(Field* dst, const Field* src, const Field& koef, size_t count) {
+  for (size_t i = Vectorized<Op>(dst, src, koef, count); i < count; ++i) {
+    if constexpr (Op == kAdd) {
+      dst[i] += src[i];
+    } else if constexpr (Op == kSub) {
+      dst[i] -= src[i];
+    } else if constexpr (Op == kScale) {
+      dst[i] *= koef;
+    } else if constexpr (Op == kAddScaled) {
+      dst[i] += koef * src[i];
+    } else {
+      dst[i] -= koef * src[i];
+    }
+  }
+}
+
+////////////////////////////////Row operations//////////////////////////////////////
+template<typename Field>
+void Add(Field* dst, const Field* src, size_t count) {
+  Apply<kAdd>(dst, src, Field(0), count);
+}
+
+template<typename Field>
+void Sub(Field* dst, const Field* src, size_t count) {
+  Apply<kSub>(dst, src, Field(0), count);
+}
+
+template<typename Field>
+void Scale(Field* dst, const Field& koef, size_t count) {
+  Apply<kScale>(dst, static_cast<const Field*>(nullptr), koef, count);
+}
+
+template<typename Field>
+void SubScaled(Field* dst, const Field* src, const Field& koef, size_t count) {
+  Apply<kSubScaled>(dst, src, koef, count);
+}
+
+template<typename Field>
+void AddScaled(Field* dst, const Field* src, const Field& koef, size_t count) {
+  Apply<kAddScaled>(dst, src, koef, count);
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Row kernels/////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Element-wise row operations behind Matrix arithmetic and Gaussian elimination.
+// double, int64_t, Residue<N> (for N <= 2^26), FastResidue<N> (for 2^16 < N < 2^31)
+// and DynResidue (for moduli below 2^31) rows run on AVX-512 or AVX2, whichever the
+// CPU has; any other Field falls back to its own operators.
+namespace Kernels {
+
+// dst += src
+template<typename Field>
+void Add(Field* dst, const Field* src, size_t count);
+
+// dst -= src
+template<typename Field>
+void Sub(Field* dst, const Field* src, size_t count);
+
+// dst *= koef
+template<typename Field>
+void Scale(Field* dst, const Field& koef, size_t count);
+
+// dst -= koef * src, the row update of elimination.
+template<typename Field>
+void SubScaled(Field* dst, const Field* src, const Field& koef, size_t count);
+
+// dst += koef * src
+template<typename Field>
+void AddScaled(Field* dst, const Field* src, const Field& koef, size_t count);
+
+}
+
+#endif //KERNELS_H_
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "LUDecomposition.h"
+
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "DynMatrix.cpp"
+#include "Gauss.cpp"
+#include "Kernels.cpp"
+#include "ThreadPool.cpp"
+
+template<typename Field>
+LUDecomposition<Field>::LUDecomposition(DynMatrix<Field> a, ThreadPool* pool)
+    : lu_(std::move(a)), permutation_(lu_.rows()) {
+  static_assert(!Gauss::IsIntegralField<Field>::value, "LUDecomposition needs a Field with exact division");
+  std::iota(permutation_.begin(), permutation_.end(), 0);
+  MatrixView<Field> m = lu_.view();
+  size_t row = 0;
+  for (size_t col = 0; col < m.cols() && row < m.rows(); ++col) {
+    size_t max_idx = row;
+    for (size_t idx = row + 1; idx < m.rows(); ++idx) {
+      if (Gauss::Abs(m[max_idx][col]) < Gauss::Abs(m[idx][col])) {
+        max_idx = idx;
+      }
+    }
+    if (m[max_idx][col] == Field(0)) {
+      continue;
+    }
+    if (max_idx != row) {
+      // Whole rows, so the multipliers stored so far follow their rows.
+      Gauss::SwapRows(m, row, max_idx);
+      std::swap(permutation_[row], permutation_[max_idx]);
+      odd_permutation_ = !odd_permutation_;
+    }
+    Gauss::PivotDivisor<Field> divide(m[row][col]);
+    Gauss::ForRows<Field>(pool, row + 1, m.rows(), m.cols() - col, [&](size_t lo, size_t hi) {
+      for (size_t other_row = lo; other_row < hi; ++other_row) {
+        if (m[other_row][col] == Field(0)) {
+          continue;
+        }
+        Field koef = divide(m[other_row][col]);
+        m[other_row][col] = koef;
+        Kernels::SubScaled(m[other_row].data() + col + 1, m[row].data() + col + 1, koef, m.cols() - col - 1);
+      }
+    });
+    pivot_cols_.push_back(col);
+    pivots_.push_back(m[row][col]);
+    ++row;
+  }
+  if constexpr (!std::is_floating_point_v<Field>) {
+    if (!pivots_.empty()) {
+      Gauss::InvertAll(std::span<Field>(pivots_));
+    }
+  }
+}
+
+template<typename Field>
+template<size_t M, size_t N>
+LUDecomposition<Field>::LUDecomposition(const Matrix<M, N, Field>& a, ThreadPool* pool)
+    : LUDecomposition(DynMatrix<Field>(a), pool) {}
+
+template<typename Field>
+void LUDecomposition<Field>::CheckSquare() const {
+  if (rows() != cols()) {
+    throw std::invalid_argument("LUDecomposition: matrix is not square");
+  }
+}
+
+template<typename Field>
+Field LUDecomposition<Field>::det() const {
+  CheckSquare();
+  if (rank() < rows()) {
+    return 0;
+  }
+  Field det = odd_permutation_ ? -1 : 1;
+  for (size_t i = 0; i < rows(); ++i) {
+    det *= lu_[i][i];
+  }
+  return det;
+}
+
+template<typename Field>
+void LUDecomposition<Field>::Substitute(MatrixView<Field> x) const {
+  size_t n = rows();
+  size_t width = x.cols();
+  if (width == 1) {
+    // A single column: dot products along the rows of the factors.
+    for (size_t i = 1; i < n; ++i) {
+      Field sum = x[i][0];
+      for (size_t j = 0; j < i; ++j) {
+        sum -= lu_[i][j] * x[j][0];
+      }
+      x[i][0] = sum;
+    }
+    for (size_t i = n; i-- > 0;) {
+      Field sum = x[i][0];
+      for (size_t j = i + 1; j < n; ++j) {
+        sum -= lu_[i][j] * x[j][0];
+      }
+      if constexpr (std::is_floating_point_v<Field>) {
+        x[i][0] = sum / pivots_[i];
+      } else {
+        x[i][0] = sum * pivots_[i];
+      }
+    }
+    return;
+  }
+  for (size_t i = 1; i < n; ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (lu_[i][j] != Field(0)) {
+        Kernels::SubScaled(x[i].data(), x[j].data(), lu_[i][j], width);
+      }
+    }
+  }
+  for (size_t i = n; i-- > 0;) {
+    for (size_t j = i + 1; j < n; ++j) {
+      if (lu_[i][j] != Field(0)) {
+        Kernels::SubScaled(x[i].data(), x[j].data(), lu_[i][j], width);
+      }
+    }
+    if constexpr (std::is_floating_point_v<Field>) {
+      for (Field& value : x[i]) {
+        value /= pivots_[i];
+      }
+    } else {
+      Kernels::Scale(x[i].data(), pivots_[i], width);
+    }
+  }
+}
+
+template<typename Field>
+std::optional<std::vector<Field>> LUDecomposition<Field>::solve(std::span<const Field> b) const {
+  CheckSquare();
+  if (b.size() != rows()) {
+    throw std::invalid_argument("LUDecomposition: right-hand side does not match");
+  }
+  if (rank() < rows()) {
+    return std::nullopt;
+  }
+  std::vector<Field> x(rows());
+  for (size_t i = 0; i < rows(); ++i) {
+    x[i] = b[permutation_[i]];
+  }
+  Substitute(MatrixView<Field>(x.data(), rows(), 1, 1));
+  return x;
+}
+
+template<typename Field>
+std::optional<DynMatrix<Field>> LUDecomposition<Field>::solve(const DynMatrix<Field>& b) const {
+  CheckSquare();
+  if (b.rows() != rows()) {
+    throw std::invalid_argument("LUDecomposition: right-hand side does not match");
+  }
+  if (rank() < rows()) {
+    return std::nullopt;
+  }
+  DynMatrix<Field> x(b.rows(), b.cols());
+  for (size_t i = 0; i < rows(); ++i) {
+    std::copy(b[permutation_[i]].begin(), b[permutation_[i]].end(), x[i].begin());
+  }
+  Substitute(x.view());
+  return x;
+}
+
+template<typename Field>
+std::optional<DynMatrix<Field>> LUDecomposition<Field>::inverse() const {
+  CheckSquare();
+  return solve(DynMatrix<Field>::identity(rows()));
+}
@@ -0,0 +1,62 @@
+#ifndef LU_DECOMPOSITION_H_
+#define LU_DECOMPOSITION_H_
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "DynMatrix.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////LU decomposition////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// PA = LU with partial pivoting, computed once in O(n^3) and then reused: det() and
+// rank() are read off the factors, and every right-hand side of solve() costs only
+// O(n^2) for the two triangular substitutions. Works for any shape, with U in row
+// echelon form (zero columns are skipped); solve() and inverse() need a square A.
+// L (unit diagonal) and U share one matrix, L below the pivots and U from them on.
+// Field must divide exactly, so built-in integers and BigInteger are rejected.
+template<typename Field>
+class LUDecomposition {
+ public:
+  // Given a pool, the row updates of the factorization run on its threads.
+  explicit LUDecomposition(DynMatrix<Field> a, ThreadPool* pool = nullptr);
+  template<size_t M, size_t N>
+  explicit LUDecomposition(const Matrix<M, N, Field>& a, ThreadPool* pool = nullptr);
+
+  size_t rows() const { return lu_.rows(); }
+  size_t cols() const { return lu_.cols(); }
+  size_t rank() const { return pivot_cols_.size(); }
+
+  // Throws std::invalid_argument unless A is square.
+  Field det() const;
+
+  // x with Ax = b, or std::nullopt when A is singular. Throws std::invalid_argument
+  // unless A is square and b has rows() elements (rows() rows for a matrix b).
+  std::optional<std::vector<Field>> solve(std::span<const Field> b) const;
+  std::optional<DynMatrix<Field>> solve(const DynMatrix<Field>& b) const;
+
+  // A^-1, or std::nullopt when A is singular.
+  std::optional<DynMatrix<Field>> inverse() const;
+
+ private:
+  void CheckSquare() const;
+  // Turns Pb, stored in x, into the solution: forward with L, back with U.
+  void Substitute(MatrixView<Field> x) const;
+
+  DynMatrix<Field> lu_;
+  // Row i of the factors is row permutation_[i] of A.
+  std::vector<size_t> permutation_;
+  std::vector<size_t> pivot_cols_;
+  // Inverses of the pivots for exact Fields, the pivots themselves for floating
+  // point, which divides so each quotient is rounded once.
+  std::vector<Field> pivots_;
+  bool odd_permutation_ = false;
+};
+
+#endif //LU_DECOMPOSITION_H_
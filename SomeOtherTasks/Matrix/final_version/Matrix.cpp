@@ -1,5 +1,14 @@
+#pragma once
+
 #include "Matrix.h"
 
+#include "Expression.cpp"
+#include "Gauss.cpp"
+#include "Gemm.cpp"
+#include "Kernels.cpp"
+#include "SmallMatrix.cpp"
+#include "ThreadPool.cpp"
+
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////Operators///////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
@@ -51,18 +60,15 @@ Residue<N, Simple>& Residue<N, Simple>::operator-=(const Residue<N>& r) {
   return *this;
 }
 template<size_t N, bool Simple>
+Residue<N, Simple> Residue<N, Simple>::inverse() const {
+  Residue result;
+  result.number = Operators::InverseMod(number, N);
+  return result;
+}
+template<size_t N, bool Simple>
 Residue<N, Simple>& Residue<N, Simple>::operator/=(const Residue<N>& r) {
   static_assert(Simple);
-  if (number >= N) {
-    number %= N;
-  }
-  for (int64_t i = 1;; ++i) {
-    if ((r.number * i) % N == number) {
-      number = i;
-      break;
-    }
-  }
-  return *this;
+  return *this *= r.inverse();
 }
 template<size_t N, bool Simple>
 Residue<N, Simple>& Residue<N, Simple>::operator*=(const Residue<N>& r) {
@@ -77,6 +83,10 @@ bool operator>(const Residue<N>& r1, const Residue<N>& r2) {
   return r1.number > r2.number;
 }
 template<size_t N>
+bool operator<(const Residue<N>& r1, const Residue<N>& r2) {
+  return r2 > r1;
+}
+template<size_t N>
 bool operator==(const Residue<N>& r1, const Residue<N>& r2) {
   return r1.number == r2.number;
 }
@@ -132,77 +142,20 @@ Matrix<M, N, Field>::Matrix(const std::initializer_list<std::initializer_list<Fi
 
 ////////////////////////////////Matrix functions////////////////////////////////////
 template<size_t M, size_t N, typename Field>
-Field Matrix<M, N, Field>::det() const {
+Field Matrix<M, N, Field>::det(ThreadPool* pool) const {
   static_assert(N == M);
-  Matrix copy = *this;
-  Field det = 1;
-  for (size_t cnt = 0; cnt < N; ++cnt) {
-    Field max_el = copy.matrix[cnt][cnt].abs();
-    size_t max_idx = cnt;
-    for (size_t row = cnt + 1; row < N; ++row) {
-      if (max_el < copy.matrix[row][cnt].abs()) {
-        max_el = copy.matrix[row][cnt].abs();
-        max_idx = row;
-      }
-    }
-    if (max_el == Field(0)) {
-      return 0;
-    }
-    if (cnt != max_idx) {
-      det *= (-1);
-      std::swap(copy.matrix[cnt], copy.matrix[max_idx]);
-    }
-    det *= copy.matrix[cnt][cnt];
-    Field koef = 0;
-    for (size_t row = cnt + 1; row < N; ++row) {
-      koef = copy.matrix[row][cnt] / copy.matrix[cnt][cnt];
-      for (size_t col = cnt; col < N; ++col) {
-        copy.matrix[row][col] -= koef * copy.matrix[cnt][col];
-      }
-    }
+  if constexpr (N != 0 && N <= Small::kMaxSize) {
+    return Small::Det(*this);
+  } else {
+    Matrix copy = *this;
+    return Gauss::Det(copy.view(), pool);
   }
-  return det;
 }
 
 template<size_t M, size_t N, typename Field>
-size_t Matrix<M, N, Field>::rank() const {
-  Matrix m = *this;
-  size_t row = 0;
-  size_t col = 0;
-  while (row < M && col < N) {
-    size_t idx = row;
-    while (idx < M) {
-      if (m.matrix[idx][col] != Field(0)) {
-        break;
-      }
-      ++idx;
-    }
-    if (M == idx) {
-      ++col;
-      continue;
-    }
-    if (idx != row) {
-      for (size_t i = row; i < N; ++i) {
-        std::swap(m.matrix[row][i], m.matrix[idx][i]);
-      }
-    }
-    Field k = m.matrix[row][col];
-    m.matrix[row][col] = Field(1);
-    for (size_t i = col + 1; i < N; ++i) {
-      m.matrix[row][i] /= k;
-    }
-    for (size_t other_row = row + 1; other_row < M; ++other_row) {
-      if (m.matrix[other_row][col] != Field(0)) {
-        Field koef = m.matrix[other_row][col] / m.matrix[col][col];
-        for (size_t i = 0; i < N; ++i) {
-          m.matrix[other_row][i] -= (m.matrix[row][i] * koef);
-        }
-      }
-    }
-    ++row;
-    ++col;
-  }
-  return (col < row ? col : row);
+size_t Matrix<M, N, Field>::rank(ThreadPool* pool) const {
+  Matrix copy = *this;
+  return Gauss::Rank(copy.view(), pool);
 }
 
 template<size_t M, size_t N, typename Field>
@@ -217,6 +170,9 @@ Field Matrix<M, N, Field>::trace() const {
 
 template<size_t M, size_t N, typename Field>
 Matrix<N, M, Field> Matrix<M, N, Field>::transposed() const {
+  if constexpr (M <= Small::kMaxSize && N <= Small::kMaxSize) {
+    return Small::Transpose(*this);
+  }
   Matrix<N, M, Field> result;
   for (size_t row = 0; row < M; ++row) {
     for (size_t col = 0; col < N; ++col) {
@@ -227,8 +183,23 @@ Matrix<N, M, Field> Matrix<M, N, Field>::transposed() const {
 }
 
 template<size_t M, size_t N, typename Field>
-void Matrix<M, N, Field>::invert() {
+void Matrix<M, N, Field>::invert(ThreadPool* pool) {
   static_assert(N == M);
+  if constexpr (N != 0 && N <= Small::kMaxSize) {
+    // A singular matrix gets its adjugate, as unspecified as elimination leaves it.
+    Matrix adj;
+    Field det = Small::Adjugate(*this, adj);
+    if (det != Field(0)) {
+      Gauss::PivotDivisor<Field> divide(det);
+      for (size_t row = 0; row < N; ++row) {
+        for (size_t col = 0; col < N; ++col) {
+          adj.matrix[row][col] = divide(adj.matrix[row][col]);
+        }
+      }
+    }
+    matrix = adj.matrix;
+    return;
+  }
   Matrix<M, N, Field> E;
   for (size_t i = 0; i < N; ++i) {
     for (size_t j = 0; j < N; ++j) {
@@ -239,43 +210,17 @@ void Matrix<M, N, Field>::invert() {
       }
     }
   }
-  GaussInvert(E);
+  Gauss::Invert(view(), E.view(), pool);
+  *this = E;
 }
 
 template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> Matrix<M, N, Field>::inverted() const {
+Matrix<M, N, Field> Matrix<M, N, Field>::inverted(ThreadPool* pool) const {
   Matrix<M, N, Field> result = *this;
-  result.invert();
+  result.invert(pool);
   return result;
 }
 
-template<size_t M, size_t N, typename Field>
-void Matrix<M, N, Field>::GaussInvert(Matrix<M, N, Field>& E) {
-  for (size_t cnt = 0; cnt < M; ++cnt) {
-    for (size_t other_row = 0; other_row < M; ++other_row) {
-      if (other_row == cnt) {
-        continue;
-      }
-      Field koef = 0;
-      if (matrix[other_row][cnt] != Field(0)) {
-        koef = matrix[other_row][cnt] / matrix[cnt][cnt];
-        for (size_t col = 0; col < M; ++col) {
-          if (col >= cnt) {
-            matrix[other_row][col] -= matrix[cnt][col] * koef;
-          }
-          E.matrix[other_row][col] -= E.matrix[cnt][col] * koef;
-        }
-      }
-    }
-  }
-  for (size_t row = 0; row < N; ++row) {
-    for (size_t col = 0; col < N; ++col) {
-      E.matrix[row][col] /= matrix[row][row];
-    }
-  }
-  *this = E;
-}
-
 ////////////////////////////////Matrix operators////////////////////////////////////
 template<size_t M, size_t N, typename Field>
 std::array<Field, N>& Matrix<M, N, Field>::operator[](size_t idx) {
@@ -286,6 +231,16 @@ const std::array<Field, N>& Matrix<M, N, Field>::operator[](size_t idx) const {
   return matrix[idx];
 }
 template<size_t M, size_t N, typename Field>
+MatrixView<Field> Matrix<M, N, Field>::view() {
+  static_assert(sizeof(matrix) == M * N * sizeof(Field));
+  return {matrix.front().data(), M, N, N};
+}
+template<size_t M, size_t N, typename Field>
+MatrixView<const Field> Matrix<M, N, Field>::view() const {
+  static_assert(sizeof(matrix) == M * N * sizeof(Field));
+  return {matrix.front().data(), M, N, N};
+}
+template<size_t M, size_t N, typename Field>
 Matrix<M, N, Field>& Matrix<M, N, Field>::operator=(const Matrix<M, N, const Field>& m) {
   matrix = m.matrix;
   return *this;
@@ -294,61 +249,101 @@ Matrix<M, N, Field>& Matrix<M, N, Field>::operator=(const Matrix<M, N, const Fie
 template<size_t M, size_t N, typename Field>
 Matrix<M, N, Field>& Matrix<M, N, Field>::operator+=(const Matrix<M, N, Field>& m) {
   for (size_t row = 0; row < M; ++row) {
-    for (size_t col = 0; col < N; ++col) {
-      matrix[row][col] += m[row][col];
-    }
+    Kernels::Add(matrix[row].data(), m[row].data(), N);
   }
   return *this;
 }
 template<size_t M, size_t N, typename Field>
 Matrix<M, N, Field>& Matrix<M, N, Field>::operator-=(const Matrix<M, N, Field>& m) {
   for (size_t row = 0; row < M; ++row) {
-    for (size_t col = 0; col < N; ++col) {
-      matrix[row][col] -= m[row][col];
-    }
+    Kernels::Sub(matrix[row].data(), m[row].data(), N);
   }
   return *this;
 }
 template<size_t M, size_t N, typename Field>
+template<typename Expr>
+Matrix<M, N, Field>::Matrix(const Lazy::Expression<Expr>& expr) {
+  static_assert(Expr::kRows == M && Expr::kCols == N, "Matrix shapes do not match");
+  static_assert(std::is_same_v<typename Expr::Field, Field>);
+  Lazy::Assign(expr.derived(), view());
+}
+template<size_t M, size_t N, typename Field>
+template<typename Expr>
+Matrix<M, N, Field>& Matrix<M, N, Field>::operator=(const Lazy::Expression<Expr>& expr) {
+  static_assert(Expr::kRows == M && Expr::kCols == N, "Matrix shapes do not match");
+  static_assert(std::is_same_v<typename Expr::Field, Field>);
+  Lazy::Assign(expr.derived(), view());
+  return *this;
+}
+template<size_t M, size_t N, typename Field>
+template<typename Expr>
+Matrix<M, N, Field>& Matrix<M, N, Field>::operator+=(const Lazy::Expression<Expr>& expr) {
+  static_assert(Expr::kRows == M && Expr::kCols == N, "Matrix shapes do not match");
+  static_assert(std::is_same_v<typename Expr::Field, Field>);
+  Lazy::Accumulate(expr.derived(), view(), Field(1));
+  return *this;
+}
+template<size_t M, size_t N, typename Field>
+template<typename Expr>
+Matrix<M, N, Field>& Matrix<M, N, Field>::operator-=(const Lazy::Expression<Expr>& expr) {
+  static_assert(Expr::kRows == M && Expr::kCols == N, "Matrix shapes do not match");
+  static_assert(std::is_same_v<typename Expr::Field, Field>);
+  Lazy::Accumulate(expr.derived(), view(), Field(0) - Field(1));
+  return *this;
+}
+template<size_t M, size_t N, typename Field>
 Matrix<M, N, Field>& Matrix<M, N, Field>::operator*=(const Field& f) {
   for (size_t row = 0; row < M; ++row) {
-    for (size_t col = 0; col < N; ++col) {
-      matrix[row][col] *= f;
-    }
+    Kernels::Scale(matrix[row].data(), f, N);
   }
   return *this;
 }
 template<size_t M, size_t N, typename Field>
 Matrix<M, M, Field>& Matrix<M, N, Field>::operator*=(const Matrix<M, M, Field>& m) {
-  std::array<std::array<Field, M>, M> new_matrix;
-  for (size_t row = 0; row < M; ++row) {
-    for (size_t col = 0; col < M; ++col) {
-      new_matrix[row][col] = Field(0);
-      for (size_t in = 0; in < M; ++in) {
-        new_matrix[row][col] += matrix[row][in] * m.matrix[in][col];
-      }
-    }
+  if constexpr (M == N && M != 0 && M <= Small::kMaxSize) {
+    *this = Small::Multiply(*this, m);
+  } else {
+    Gemm::MultiplyInPlace(view(), m.view());
   }
-  matrix = new_matrix;
   return *this;
 }
-template<size_t M, size_t N, typename Field, size_t K>
-Matrix<M, K, Field> operator*(const Matrix<M, N, Field>& m1, const Matrix<N, K, Field>& m2) {
-  Matrix<M, K, Field> new_matrix;
-  for (size_t row = 0; row < M; ++row) {
-    for (size_t col = 0; col < K; ++col) {
-      for (size_t in = 0; in < N; ++in) {
-        new_matrix[row][col] += m1[row][in] * m2[in][col];
+template<size_t M, size_t N, typename Field>
+Matrix<M, N, Field> Matrix<M, N, Field>::pow(uint64_t k) const {
+  static_assert(N == M);
+  Matrix result;
+  if constexpr (N != 0 && N <= Small::kMaxSize) {
+    for (size_t i = 0; i < N; ++i) {
+      result.matrix[i][i] = 1;
+    }
+    for (Matrix square = *this; k != 0; k >>= 1) {
+      if (k & 1) {
+        result = Small::Multiply(result, square);
+      }
+      if (k > 1) {
+        square = Small::Multiply(square, square);
       }
     }
+    return result;
   }
-  return new_matrix;
+  // Scratch on the heap: Matrix itself lives on the stack and may be large.
+  std::vector<Field> scratch(N * N);
+  Gemm::Power(view(), k, result.view(), MatrixView<Field>(scratch.data(), N, N, N));
+  return result;
+}
+template<size_t N, size_t K, typename Field>
+std::optional<Matrix<N, K, Field>> solve(const Matrix<N, N, Field>& a, const Matrix<N, K, Field>& b, ThreadPool* pool) {
+  Matrix<N, N, Field> copy = a;
+  Matrix<N, K, Field> x = b;
+  if (!Gauss::Solve(copy.view(), x.view(), pool)) {
+    return std::nullopt;
+  }
+  return x;
 }
 template<size_t M, size_t N, typename Field>
 bool operator==(const Matrix<M, N, Field>& m1, const Matrix<M, N, Field>& m2) {
   for (size_t row = 0; row < M; ++row) {
     for (size_t col = 0; col < N; ++col) {
-      if (m1.matrix[row][col] != m2.matrix[row][col]) {
+      if (m1[row][col] != m2[row][col]) {
         return false;
       }
     }
@@ -359,44 +354,63 @@ template<size_t M, size_t N, typename Field>
 bool operator!=(const Matrix<M, N, Field>& m1, const Matrix<M, N, Field>& m2) {
   return !(m1 == m2);
 }
-template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator+(Matrix<M, N, Field> m1, const Matrix<M, N, Field>& m2) {
-  return m1 += m2;
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Sum<Lazy::NodeOf<L>, Lazy::NodeOf<R>, false> operator+(const L& l, const R& r) {
+  return {Lazy::Wrap(l), Lazy::Wrap(r)};
 }
-template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator-(Matrix<M, N, Field> m1, const Matrix<M, N, Field>& m2) {
-  return m1 -= m2;
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Sum<Lazy::NodeOf<L>, Lazy::NodeOf<R>, true> operator-(const L& l, const R& r) {
+  return {Lazy::Wrap(l), Lazy::Wrap(r)};
 }
-template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator*(Matrix<M, N, Field> m, int64_t r) {
-  return m *= r;
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Product<Lazy::NodeOf<L>, Lazy::NodeOf<R>> operator*(const L& l, const R& r) {
+  return {Lazy::Wrap(l), Lazy::Wrap(r)};
 }
-template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator*(int64_t r, Matrix<M, N, Field> m) {
-  return m *= r;
+template<typename E> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const E& e, int64_t r) {
+  return {Lazy::Wrap(e), typename Lazy::NodeOf<E>::Field(r)};
+}
+template<typename E> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(int64_t r, const E& e) {
+  return e * r;
+}
+template<typename E, size_t K> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const E& e, const Residue<K>& r) {
+  return {Lazy::Wrap(e), typename Lazy::NodeOf<E>::Field(r)};
 }
-template<size_t M, size_t N, size_t K, typename Field>
-Matrix<M, N, Field> operator*(Matrix<M, N, Field> m, const Residue<K>& r) {
-  return m *= r;
+template<typename E, size_t K> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const Residue<K>& r, const E& e) {
+  return e * r;
 }
-template<size_t M, size_t N, size_t K, typename Field>
-Matrix<M, N, Field> operator*(const Residue<K>& r, Matrix<M, N, Field> m) {
-  return m *= r;
+template<typename L, typename R>
+  requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R> && (Lazy::kIsExpression<L> || Lazy::kIsExpression<R>))
+bool operator==(const L& l, const R& r) {
+  return Lazy::Wrap(l).eval() == Lazy::Wrap(r).eval();
+}
+template<typename L, typename R>
+  requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R> && (Lazy::kIsExpression<L> || Lazy::kIsExpression<R>))
+bool operator!=(const L& l, const R& r) {
+  return !(l == r);
+}
+template<typename E> requires Lazy::kIsExpression<E>
+std::ostream& operator<<(std::ostream& out, const E& e) {
+  return out << e.eval();
 }
 template<size_t M, size_t N, typename Field>
 std::ostream& operator<<(std::ostream& out, const Matrix<M, N, Field>& m) {
   for (size_t row = 0; row < M; ++row) {
     for (size_t col = 0; col < N; ++col) {
-      out << m.matrix[row][col] << " ";
+      out << m[row][col] << " ";
     }
     out << "\n";
   }
+  return out;
 }
 template<size_t M, size_t N, typename Field>
 std::istream& operator>>(std::istream& in, Matrix<M, N, Field>& m) {
   for (size_t row = 0; row < M; ++row) {
     for (size_t col = 0; col < N; ++col) {
-      in >> m.matrix[row][col];
+      in >> m[row][col];
     }
   }
   return in;
@@ -404,14 +418,14 @@ std::istream& operator>>(std::istream& in, Matrix<M, N, Field>& m) {
 
 ////////////////////////////////Matrix getters//////////////////////////////////////
 template<size_t M, size_t N, typename Field>
-std::array<Field, M> Matrix<M, N, Field>::getRow(size_t idx) const {
+std::array<Field, N> Matrix<M, N, Field>::getRow(size_t idx) const {
+  return matrix[idx];
+}
+template<size_t M, size_t N, typename Field>
+std::array<Field, M> Matrix<M, N, Field>::getColumn(size_t idx) const {
   std::array<Field, M> arr;
   for (size_t i = 0; i < M; ++i) {
-    arr[i] = matrix[idx][i];
+    arr[i] = matrix[i][idx];
   }
   return arr;
-}
-template<size_t M, size_t N, typename Field>
-std::array<Field, N> Matrix<M, N, Field>::getColumn(size_t idx) const {
-  return matrix[idx];
 }
\ No newline at end of file
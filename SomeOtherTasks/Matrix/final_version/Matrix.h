@@ -3,10 +3,17 @@
 
 #include <array>
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "Expression.h"
+#include "FastResidue.h"
+#include "Gemm.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////Operators///////////////////////////////////////////
@@ -49,14 +56,19 @@ struct Simple {
 
 template<size_t N, bool Simple = Operators::Simple<N>::simple>
 class Residue {
-  friend std::ostream& operator<<(std::ostream& os, const Residue<N>& r);
-  friend bool operator>(const Residue<N>& r1, const Residue<N>& r2);
-  friend bool operator==(const Residue<N>& r1, const Residue<N>& r2);
+  template<size_t K>
+  friend std::ostream& operator<<(std::ostream& os, const Residue<K>& r);
+  template<size_t K>
+  friend bool operator>(const Residue<K>& r1, const Residue<K>& r2);
+  template<size_t K>
+  friend bool operator==(const Residue<K>& r1, const Residue<K>& r2);
  public:
   Residue() = default;
   Residue(int num);
   explicit operator int() const { return number; }
   Residue abs() const { return *this; }
+  // Operators::InverseMod: throws std::domain_error unless number is coprime to N.
+  Residue inverse() const;
   Residue& operator+=(const Residue<N>& r);
   Residue& operator-=(const Residue<N>& r);
   Residue& operator/=(const Residue<N>& r);
@@ -65,6 +77,8 @@ class Residue {
   size_t number;
 };
 
+template<size_t N>
+bool operator<(const Residue<N>& r1, const Residue<N>& r2);
 template<size_t N>
 bool operator>=(const Residue<N>& r1, const Residue<N>& r2);
 template<size_t N>
@@ -78,6 +92,14 @@ Residue<N> operator*(Residue<N> r1, const Residue<N>& r2);
 template<size_t N>
 Residue<N> operator/(Residue<N> r1, const Residue<N>& r2);
 
+// Every product of residues ends in a hardware division, so recursing pays off early.
+namespace Gemm {
+template<size_t N, bool Simple>
+struct StrassenCrossover<Residue<N, Simple>> {
+  static constexpr size_t value = 16;
+};
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////Matrix//////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
@@ -87,57 +109,103 @@ class Matrix {
  public:
   Matrix();
   Matrix(const std::initializer_list<std::initializer_list<Field>>& list);
+  // Evaluates a lazy expression (Expression.h) of the same shape and Field.
+  template<typename Expr>
+  Matrix(const Lazy::Expression<Expr>&);
 
   std::array<Field, N>& operator[](size_t);
   const std::array<Field, N>& operator[](size_t) const;
 
+  // The rows are laid out back to back, so the whole matrix is one strided view.
+  MatrixView<Field> view();
+  MatrixView<const Field> view() const;
+
   Matrix& operator=(const Matrix<M, N, const Field>&);
   Matrix& operator+=(const Matrix<M, N, Field>&);
   Matrix& operator-=(const Matrix<M, N, Field>&);
+  // The expression is written straight into this matrix, through a temporary only
+  // when one of its products reads this matrix.
+  template<typename Expr>
+  Matrix& operator=(const Lazy::Expression<Expr>&);
+  template<typename Expr>
+  Matrix& operator+=(const Lazy::Expression<Expr>&);
+  template<typename Expr>
+  Matrix& operator-=(const Lazy::Expression<Expr>&);
   Matrix& operator*=(const Field&);
   Matrix<M, M, Field>& operator*=(const Matrix<M, M, Field>&);
 
-  template<size_t K>
-  friend Matrix<M, K, Field> operator*(const Matrix<M, N, Field>&, const Matrix<N, K, Field>&);
-  friend bool operator==(const Matrix<M, N, Field>&, const Matrix<M, N, Field>&);
-  friend std::ostream& operator<<(std::ostream&, const Matrix<M, N, Field>&);
-  friend std::istream& operator>>(std::istream&, Matrix<M, N, Field>&);
+  // this^k by binary powering, O(N^3 log k); k = 0 gives the identity.
+  Matrix pow(uint64_t k) const;
 
-  Field det() const;
-  size_t rank() const;
+  // Given a pool, elimination runs on its threads. Up to 4x4 (Small::kMaxSize),
+  // det, invert, products, powers and transposes take closed forms instead.
+  Field det(ThreadPool* pool = nullptr) const;
+  size_t rank(ThreadPool* pool = nullptr) const;
   Field trace() const;
   Matrix<N, M, Field> transposed() const;
-  void invert();
-  Matrix<M, N, Field> inverted() const;
+  void invert(ThreadPool* pool = nullptr);
+  Matrix<M, N, Field> inverted(ThreadPool* pool = nullptr) const;
 
-  std::array<Field, M> getRow(size_t) const;
-  std::array<Field, N> getColumn(size_t) const;
+  std::array<Field, N> getRow(size_t) const;
+  std::array<Field, M> getColumn(size_t) const;
 
  private:
-  void GaussInvert(Matrix<M, N, Field>&);
   std::array<std::array<Field, N>, M> matrix;
 };
 
-template<size_t M, size_t N, typename Field>
-bool operator!=(const Matrix<M, N, Field>&, const Matrix<M, N, Field>&);
+// x with a * x = b, one column of x per column of b (K = 1 for a single system),
+// or std::nullopt when a is singular. Runs one Gauss-Jordan elimination on copies,
+// about a third of the work of a.inverted() * b.
+template<size_t N, size_t K, typename Field>
+std::optional<Matrix<N, K, Field>> solve(const Matrix<N, N, Field>& a, const Matrix<N, K, Field>& b,
+                                         ThreadPool* pool = nullptr);
 
 template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator+(Matrix<M, N, Field>, const Matrix<M, N, Field>&);
+bool operator==(const Matrix<M, N, Field>&, const Matrix<M, N, Field>&);
 
 template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator-(Matrix<M, N, Field>, const Matrix<M, N, Field>&);
+bool operator!=(const Matrix<M, N, Field>&, const Matrix<M, N, Field>&);
 
 template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator*(Matrix<M, N, Field>, int64_t);
+std::ostream& operator<<(std::ostream&, const Matrix<M, N, Field>&);
 
 template<size_t M, size_t N, typename Field>
-Matrix<M, N, Field> operator*(int64_t, Matrix<M, N, Field>);
+std::istream& operator>>(std::istream&, Matrix<M, N, Field>&);
+
+// Sums, differences and products of matrices and expressions, and their multiples,
+// are lazy: they return Lazy nodes that are evaluated on assignment to a Matrix.
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Sum<Lazy::NodeOf<L>, Lazy::NodeOf<R>, false> operator+(const L&, const R&);
+
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Sum<Lazy::NodeOf<L>, Lazy::NodeOf<R>, true> operator-(const L&, const R&);
+
+template<typename L, typename R> requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R>)
+Lazy::Product<Lazy::NodeOf<L>, Lazy::NodeOf<R>> operator*(const L&, const R&);
+
+template<typename E> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const E&, int64_t);
+
+template<typename E> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(int64_t, const E&);
+
+template<typename E, size_t K> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const E&, const Residue<K>&);
+
+template<typename E, size_t K> requires Lazy::kIsOperand<E>
+Lazy::Scaled<Lazy::NodeOf<E>> operator*(const Residue<K>&, const E&);
+
+// Comparing or printing an expression evaluates it first.
+template<typename L, typename R>
+  requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R> && (Lazy::kIsExpression<L> || Lazy::kIsExpression<R>))
+bool operator==(const L&, const R&);
 
-template<size_t M, size_t N, size_t K, typename Field>
-Matrix<M, N, Field> operator*(Matrix<M, N, Field>, const Residue<K>&);
+template<typename L, typename R>
+  requires (Lazy::kIsOperand<L> && Lazy::kIsOperand<R> && (Lazy::kIsExpression<L> || Lazy::kIsExpression<R>))
+bool operator!=(const L&, const R&);
 
-template<size_t M, size_t N, size_t K, typename Field>
-Matrix<M, N, Field> operator*(const Residue<K>&, Matrix<M, N, Field>);
+template<typename E> requires Lazy::kIsExpression<E>
+std::ostream& operator<<(std::ostream&, const E&);
 
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////Square Matrix///////////////////////////////////////
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MatrixPowers.h"
+
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "DynMatrix.cpp"
+#include "Gemm.cpp"
+
+template<typename Field>
+MatrixPowers<Field>::MatrixPowers(DynMatrix<Field> a) {
+  if (a.rows() != a.cols()) {
+    throw std::invalid_argument("MatrixPowers: matrix is not square");
+  }
+  squares_.push_back(std::move(a));
+}
+
+template<typename Field>
+template<size_t N>
+MatrixPowers<Field>::MatrixPowers(const Matrix<N, N, Field>& a) : MatrixPowers(DynMatrix<Field>(a)) {}
+
+template<typename Field>
+const DynMatrix<Field>& MatrixPowers<Field>::square(size_t bit) {
+  while (squares_.size() <= bit) {
+    const DynMatrix<Field>& last = squares_.back();
+    DynMatrix<Field> next(size(), size());
+    Gemm::MultiplyAdd<Field>(last.view(), last.view(), next.view());
+    squares_.push_back(std::move(next));
+  }
+  return squares_[bit];
+}
+
+template<typename Field>
+std::vector<Field> MatrixPowers<Field>::apply(uint64_t k, std::span<const Field> v) {
+  size_t n = size();
+  if (v.size() != n) {
+    throw std::invalid_argument("MatrixPowers: vector size does not match");
+  }
+  std::vector<Field> current(v.begin(), v.end());
+  std::vector<Field> next(n);
+  for (; k != 0; k &= k - 1) {
+    const DynMatrix<Field>& a = square(std::countr_zero(k));
+    for (size_t row = 0; row < n; ++row) {
+      Field sum = 0;
+      for (size_t col = 0; col < n; ++col) {
+        sum += a[row][col] * current[col];
+      }
+      next[row] = sum;
+    }
+    std::swap(current, next);
+  }
+  return current;
+}
@@ -0,0 +1,40 @@
+#ifndef MATRIX_POWERS_H_
+#define MATRIX_POWERS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "DynMatrix.h"
+#include "Matrix.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Matrix powers///////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Applies powers of one square matrix A to vectors, e.g. to jump a linear recurrence
+// k steps ahead. A^k v is the product of the squares A^(2^i) over the set bits of k,
+// and they commute, so with the squares cached a query costs O(n^2 log k) instead of
+// the O(n^3 log k) of A.pow(k) * v. Squares are computed on first use and kept.
+template<typename Field>
+class MatrixPowers {
+ public:
+  // Throws std::invalid_argument unless a is square.
+  explicit MatrixPowers(DynMatrix<Field> a);
+  template<size_t N>
+  explicit MatrixPowers(const Matrix<N, N, Field>& a);
+
+  size_t size() const { return squares_.front().rows(); }
+
+  // A^(2^bit), squaring up to it the first time.
+  const DynMatrix<Field>& square(size_t bit);
+
+  // A^k v; throws std::invalid_argument unless v.size() == size().
+  std::vector<Field> apply(uint64_t k, std::span<const Field> v);
+
+ private:
+  std::vector<DynMatrix<Field>> squares_;
+};
+
+#endif //MATRIX_POWERS_H_
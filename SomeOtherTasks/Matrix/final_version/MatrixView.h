@@ -0,0 +1,43 @@
+#ifndef MATRIX_VIEW_H_
+#define MATRIX_VIEW_H_
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Matrix view/////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Non-owning window of rows x cols elements over a row-major buffer whose
+// consecutive rows lie stride elements apart. Blocks of a view are views again,
+// so slicing never copies.
+template<typename Field>
+class MatrixView {
+ public:
+  MatrixView() = default;
+  MatrixView(Field* data, size_t rows, size_t cols, size_t stride)
+      : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+  template<typename Other, typename = std::enable_if_t<std::is_convertible_v<Other (*)[], Field (*)[]>>>
+  MatrixView(const MatrixView<Other>& view)
+      : data_(view.data()), rows_(view.rows()), cols_(view.cols()), stride_(view.stride()) {}
+
+  std::span<Field> operator[](size_t row) const { return {data_ + row * stride_, cols_}; }
+
+  Field* data() const { return data_; }
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t stride() const { return stride_; }
+
+  MatrixView block(size_t row, size_t col, size_t rows, size_t cols) const {
+    return {data_ + row * stride_ + col, rows, cols, stride_};
+  }
+
+ private:
+  Field* data_ = nullptr;
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t stride_ = 0;
+};
+
+#endif //MATRIX_VIEW_H_
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Modular.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "DynResidue.cpp"
+#include "FastResidue.h"
+#include "Gauss.h"
+#include "ThreadPool.cpp"
+
+namespace Modular {
+
+inline std::vector<uint64_t> Primes(size_t count) {
+  std::vector<uint64_t> primes;
+  for (uint64_t candidate = (uint64_t(1) << 31) - 1; primes.size() < count; candidate -= 2) {
+    if (Operators::IsPrime(candidate)) {
+      primes.push_back(candidate);
+    }
+  }
+  return primes;
+}
+
+// Smallest number of Primes() whose product exceeds 2^bits.
+inline size_t PrimesFor(double bits) {
+  size_t count = 1;
+  // Every prime is above 2^30.99, so this is a lower bound on log2 of the product.
+  while (double(count) * 30.99 <= bits) {
+    ++count;
+  }
+  return count;
+}
+
+template<typename Field>
+uint64_t Reduce(const Field& value, uint64_t p) {
+  using Signed = std::conditional_t<(sizeof(Field) > sizeof(int64_t)), __int128, int64_t>;
+  using Unsigned = std::conditional_t<(sizeof(Field) > sizeof(int64_t)), unsigned __int128, uint64_t>;
+  // Not is_signed_v: __int128 is no integral type in strict ISO mode.
+  if constexpr (Field(-1) < Field(0)) {
+    Signed rem = Signed(value) % Signed(p);
+    return uint64_t(rem < 0 ? rem + Signed(p) : rem);
+  } else {
+    return uint64_t(Unsigned(value) % p);
+  }
+}
+
+// log2 of the Euclidean norm of every row, -inf for a zero row.
+template<typename Field>
+std::vector<double> RowNormBits(MatrixView<const Field> a) {
+  std::vector<double> bits(a.rows());
+  for (size_t row = 0; row < a.rows(); ++row) {
+    double sum = 0;
+    for (const Field& value : a[row]) {
+      sum += double(value) * double(value);
+    }
+    bits[row] = 0.5 * std::log2(sum);
+  }
+  return bits;
+}
+
+// Copies a modulo the prime of the current ModulusScope into buffer as a rows x cols
+// row-major matrix.
+template<typename Field>
+MatrixView<DynResidue> Load(MatrixView<const Field> a, std::vector<DynResidue>& buffer) {
+  uint64_t p = ModulusScope::Required().modulus();
+  buffer.resize(a.rows() * a.cols());
+  for (size_t row = 0; row < a.rows(); ++row) {
+    for (size_t col = 0; col < a.cols(); ++col) {
+      buffer[row * a.cols() + col] = DynResidue(static_cast<int64_t>(Reduce(a[row][col], p)));
+    }
+  }
+  return MatrixView<DynResidue>(buffer.data(), a.rows(), a.cols(), a.cols());
+}
+
+// Runs task(index, buffer, pool) for every prime: across the pool's threads when there
+// are enough primes to go around, otherwise one by one with the rows split instead.
+template<typename Task>
+void ForPrimes(size_t count, ThreadPool* pool, Task&& task) {
+  if (pool == nullptr || count < pool->size()) {
+    std::vector<DynResidue> buffer;
+    for (size_t index = 0; index < count; ++index) {
+      task(index, buffer, pool);
+    }
+    return;
+  }
+  pool->ParallelFor(0, count, [&](size_t lo, size_t hi) {
+    std::vector<DynResidue> buffer;
+    for (size_t index = lo; index < hi; ++index) {
+      task(index, buffer, nullptr);
+    }
+  });
+}
+
+// Garner: turns the residues of x modulo primes into the mixed radix digits
+// x = d0 + d1 * p0 + d2 * p0 * p1 + ...
+inline std::vector<uint64_t> MixedRadix(const std::vector<uint64_t>& residues, const std::vector<uint64_t>& primes) {
+  std::vector<uint64_t> digits(residues.size());
+  for (size_t i = 0; i < residues.size(); ++i) {
+    uint64_t p = primes[i];
+    uint64_t value = 0;
+    uint64_t product = 1;
+    for (size_t j = 0; j < i; ++j) {
+      value = (value + digits[j] * product) % p;
+      product = product * (primes[j] % p) % p;
+    }
+    digits[i] = (residues[i] + p - value) % p * Operators::InverseMod(product, p) % p;
+  }
+  return digits;
+}
+
+template<typename Field>
+Field Det(MatrixView<const Field> a, ThreadPool* pool) {
+  std::vector<double> norms = RowNormBits(a);
+  double bits = 0;
+  for (double norm : norms) {
+    if (norm == -std::numeric_limits<double>::infinity()) {
+      return 0;
+    }
+    bits += norm;
+  }
+  // |det| <= 2^bits by Hadamard, and it fits into Field anyway; one more bit for the sign.
+  bits = std::min(bits, double(std::numeric_limits<Field>::digits)) + 1;
+  std::vector<uint64_t> primes = Primes(PrimesFor(bits));
+  std::vector<uint64_t> residues(primes.size());
+  ForPrimes(primes.size(), pool, [&](size_t index, std::vector<DynResidue>& buffer, ThreadPool* rows_pool) {
+    ModulusScope scope(primes[index]);
+    residues[index] = static_cast<uint64_t>(static_cast<int>(Gauss::DivisionDet(Load(a, buffer), rows_pool)));
+  });
+  std::vector<uint64_t> digits = MixedRadix(residues, primes);
+  // (M - 1) / 2 has the digits (p_i - 1) / 2, so comparing digits from the top tells
+  // whether the determinant is x or x - M.
+  bool negative = false;
+  for (size_t i = digits.size(); i > 0; --i) {
+    if (digits[i - 1] != (primes[i - 1] - 1) / 2) {
+      negative = digits[i - 1] > (primes[i - 1] - 1) / 2;
+      break;
+    }
+  }
+  // Both x and M are accumulated modulo 2^width, which is exact for a result that fits.
+  using Unsigned = std::conditional_t<(sizeof(Field) > sizeof(uint64_t)), unsigned __int128, uint64_t>;
+  Unsigned value = 0;
+  Unsigned modulus = 1;
+  for (size_t i = digits.size(); i > 0; --i) {
+    value = value * primes[i - 1] + digits[i - 1];
+    modulus *= primes[i - 1];
+  }
+  return static_cast<Field>(negative ? value - modulus : value);
+}
+
+// rank modulo p never exceeds the rank, and is equal to it unless p divides the
+// nonzero minors of that size. Those are bounded by the product of the largest row
+// norms, so once the product of the primes exceeds it, some prime sees the rank.
+template<typename Field>
+size_t Rank(MatrixView<const Field> a, ThreadPool* pool) {
+  size_t full = std::min(a.rows(), a.cols());
+  std::vector<double> norms = RowNormBits(a);
+  std::sort(norms.begin(), norms.end(), std::greater<>());
+  double bits = 0;
+  for (size_t row = 0; row < full; ++row) {
+    bits += std::max(norms[row], 0.0);
+  }
+  std::vector<uint64_t> primes = Primes(PrimesFor(bits));
+  std::atomic<size_t> rank = 0;
+  ForPrimes(primes.size(), pool, [&](size_t index, std::vector<DynResidue>& buffer, ThreadPool* rows_pool) {
+    if (rank.load(std::memory_order_relaxed) == full) {
+      return;
+    }
+    ModulusScope scope(primes[index]);
+    size_t rank_mod_p = Gauss::DivisionRank(Load(a, buffer), rows_pool);
+    size_t seen = rank.load(std::memory_order_relaxed);
+    while (seen < rank_mod_p && !rank.compare_exchange_weak(seen, rank_mod_p, std::memory_order_relaxed)) {
+    }
+  });
+  return rank;
+}
+
+}
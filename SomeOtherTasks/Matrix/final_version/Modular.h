@@ -0,0 +1,36 @@
+#ifndef MODULAR_H_
+#define MODULAR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Modular/////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Exact determinant and rank of integer matrices through elimination modulo several
+// word-sized primes. Residues of the determinant are glued back with CRT (Garner's
+// mixed radix) once the product of the primes exceeds twice Hadamard's bound, so all
+// the O(n^3) work is machine-word arithmetic: Gauss over DynResidue in a ModulusScope
+// of each prime. Primes run on the pool's threads; when there are fewer primes than
+// threads, the rows of each elimination are split instead.
+namespace Modular {
+
+// count distinct primes just below 2^31, largest first. Residues stay below 2^31,
+// which keeps the row updates on the vector kernels for DynResidue.
+std::vector<uint64_t> Primes(size_t count);
+
+// Field is a built-in integer type and the determinant fits into it.
+template<typename Field>
+Field Det(MatrixView<const Field> a, ThreadPool* pool = nullptr);
+
+template<typename Field>
+size_t Rank(MatrixView<const Field> a, ThreadPool* pool = nullptr);
+
+}
+
+#endif //MODULAR_H_
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "SmallMatrix.h"
+
+#include <type_traits>
+#include <utility>
+
+#include "Kernels.cpp"
+
+namespace Small {
+
+// body(integral_constant<size_t, I>()) for I = 0, ..., Count - 1, unrolled.
+template<size_t Count, typename Body>
+void Unroll(Body&& body) {
+  [&]<size_t... I>(std::index_sequence<I...>) {
+    (body(std::integral_constant<size_t, I>()), ...);
+  }(std::make_index_sequence<Count>());
+}
+
+////////////////////////////////Determinant/////////////////////////////////////////
+template<size_t N, typename Field>
+Field Det(const Matrix<N, N, Field>& a) {
+  static_assert(1 <= N && N <= kMaxSize);
+  if constexpr (N == 1) {
+    return a[0][0];
+  } else if constexpr (N == 2) {
+    return a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  } else if constexpr (N == 3) {
+    return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+         - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+         + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+  } else {
+    // Laplace expansion along the top two rows: their 2x2 minors times the
+    // complementary minors of the bottom two.
+    Field s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    Field s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    Field s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    Field s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    Field s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    Field s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    Field c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+    Field c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    Field c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    Field c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    Field c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    Field c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+}
+
+////////////////////////////////Adjugate////////////////////////////////////////////
+template<size_t N, typename Field>
+Field Adjugate(const Matrix<N, N, Field>& a, Matrix<N, N, Field>& adj) {
+  static_assert(1 <= N && N <= kMaxSize);
+  if constexpr (N == 1) {
+    adj[0][0] = 1;
+    return a[0][0];
+  } else if constexpr (N == 2) {
+    adj[0][0] = a[1][1];
+    adj[0][1] = Field(0) - a[0][1];
+    adj[1][0] = Field(0) - a[1][0];
+    adj[1][1] = a[0][0];
+    return a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  } else if constexpr (N == 3) {
+    adj[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    adj[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    adj[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    adj[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    adj[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    adj[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    adj[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    adj[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    adj[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+    return a[0][0] * adj[0][0] + a[0][1] * adj[1][0] + a[0][2] * adj[2][0];
+  } else {
+    // The same twelve 2x2 minors as Det, each cofactor a 3-term combination of them.
+    Field s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    Field s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    Field s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    Field s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    Field s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    Field s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    Field c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+    Field c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    Field c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    Field c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    Field c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    Field c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    adj[0][0] = a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3;
+    adj[0][1] = a[0][2] * c4 - a[0][1] * c5 - a[0][3] * c3;
+    adj[0][2] = a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3;
+    adj[0][3] = a[2][2] * s4 - a[2][1] * s5 - a[2][3] * s3;
+    adj[1][0] = a[1][2] * c2 - a[1][0] * c5 - a[1][3] * c1;
+    adj[1][1] = a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1;
+    adj[1][2] = a[3][2] * s2 - a[3][0] * s5 - a[3][3] * s1;
+    adj[1][3] = a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1;
+    adj[2][0] = a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0;
+    adj[2][1] = a[0][1] * c2 - a[0][0] * c4 - a[0][3] * c0;
+    adj[2][2] = a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0;
+    adj[2][3] = a[2][1] * s2 - a[2][0] * s4 - a[2][3] * s0;
+    adj[3][0] = a[1][1] * c1 - a[1][0] * c3 - a[1][2] * c0;
+    adj[3][1] = a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0;
+    adj[3][2] = a[3][1] * s1 - a[3][0] * s3 - a[3][2] * s0;
+    adj[3][3] = a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0;
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+}
+
+////////////////////////////////Double registers////////////////////////////////////
+#ifdef MATRIX_SIMD_KERNELS
+
+// Row i of c is the sum over l of a[i][l] times row l of b. The sum runs in the same
+// order as the scalar loop, without fused multiply-adds, so results are identical.
+template<size_t M, size_t N>
+__attribute__((target("avx2"))) void MultiplyRowsAvx(const double* a, const double* b, double* c) {
+  __m256d rows[N];
+  for (size_t l = 0; l < N; ++l) {
+    rows[l] = _mm256_loadu_pd(b + 4 * l);
+  }
+  for (size_t i = 0; i < M; ++i) {
+    __m256d sum = _mm256_mul_pd(_mm256_broadcast_sd(a + i * N), rows[0]);
+    for (size_t l = 1; l < N; ++l) {
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_broadcast_sd(a + i * N + l), rows[l]));
+    }
+    _mm256_storeu_pd(c + 4 * i, sum);
+  }
+}
+
+// SSE2 is part of x86-64, so 2-wide rows need no dispatch.
+template<size_t M, size_t N>
+void MultiplyRowsSse2(const double* a, const double* b, double* c) {
+  __m128d rows[N];
+  for (size_t l = 0; l < N; ++l) {
+    rows[l] = _mm_loadu_pd(b + 2 * l);
+  }
+  for (size_t i = 0; i < M; ++i) {
+    __m128d sum = _mm_mul_pd(_mm_set1_pd(a[i * N]), rows[0]);
+    for (size_t l = 1; l < N; ++l) {
+      sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(a[i * N + l]), rows[l]));
+    }
+    _mm_storeu_pd(c + 2 * i, sum);
+  }
+}
+
+inline __attribute__((target("avx2"))) void Transpose4Avx(const double* a, double* t) {
+  __m256d r0 = _mm256_loadu_pd(a);
+  __m256d r1 = _mm256_loadu_pd(a + 4);
+  __m256d r2 = _mm256_loadu_pd(a + 8);
+  __m256d r3 = _mm256_loadu_pd(a + 12);
+  // Pairs (r0[j], r1[j]) and (r2[j], r3[j]), even j in lo and odd j in hi.
+  __m256d lo01 = _mm256_unpacklo_pd(r0, r1);
+  __m256d hi01 = _mm256_unpackhi_pd(r0, r1);
+  __m256d lo23 = _mm256_unpacklo_pd(r2, r3);
+  __m256d hi23 = _mm256_unpackhi_pd(r2, r3);
+  _mm256_storeu_pd(t, _mm256_permute2f128_pd(lo01, lo23, 0x20));
+  _mm256_storeu_pd(t + 4, _mm256_permute2f128_pd(hi01, hi23, 0x20));
+  _mm256_storeu_pd(t + 8, _mm256_permute2f128_pd(lo01, lo23, 0x31));
+  _mm256_storeu_pd(t + 12, _mm256_permute2f128_pd(hi01, hi23, 0x31));
+}
+
+#endif
+
+////////////////////////////////Product/////////////////////////////////////////////
+template<size_t M, size_t N, size_t K, typename Field>
+Matrix<M, K, Field> Multiply(const Matrix<M, N, Field>& a, const Matrix<N, K, Field>& b) {
+  static_assert(1 <= N && M <= kMaxSize && N <= kMaxSize && K <= kMaxSize);
+  Matrix<M, K, Field> c;
+#ifdef MATRIX_SIMD_KERNELS
+  if constexpr (std::is_same_v<Field, double> && K == 4) {
+    if (Kernels::CpuIsa() != Kernels::Isa::kScalar) {
+      MultiplyRowsAvx<M, N>(a.view().data(), b.view().data(), c.view().data());
+      return c;
+    }
+  }
+  if constexpr (std::is_same_v<Field, double> && K == 2) {
+    MultiplyRowsSse2<M, N>(a.view().data(), b.view().data(), c.view().data());
+    return c;
+  }
+#endif
+  Unroll<M>([&](auto i) {
+    Unroll<K>([&](auto j) {
+      c[i][j] = [&]<size_t... L>(std::index_sequence<L...>) {
+        return (... + (a[i][L] * b[L][j]));
+      }(std::make_index_sequence<N>());
+    });
+  });
+  return c;
+}
+
+////////////////////////////////Transpose///////////////////////////////////////////
+template<size_t M, size_t N, typename Field>
+Matrix<N, M, Field> Transpose(const Matrix<M, N, Field>& a) {
+  static_assert(M <= kMaxSize && N <= kMaxSize);
+  Matrix<N, M, Field> t;
+#ifdef MATRIX_SIMD_KERNELS
+  if constexpr (std::is_same_v<Field, double> && M == 4 && N == 4) {
+    if (Kernels::CpuIsa() != Kernels::Isa::kScalar) {
+      Transpose4Avx(a.view().data(), t.view().data());
+      return t;
+    }
+  }
+#endif
+  Unroll<M>([&](auto i) {
+    Unroll<N>([&](auto j) {
+      t[j][i] = a[i][j];
+    });
+  });
+  return t;
+}
+
+}
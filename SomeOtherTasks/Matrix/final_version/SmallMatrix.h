@@ -0,0 +1,37 @@
+#ifndef SMALL_MATRIX_H_
+#define SMALL_MATRIX_H_
+
+#include <cstddef>
+
+#include "Matrix.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Small matrices//////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Closed forms behind Matrix for dimensions up to kMaxSize, chosen with if constexpr,
+// so 2x2 to 4x4 transforms and recurrences skip elimination, blocking and dispatch.
+// Every loop runs over template indices and unrolls completely; det and the inverse
+// come from cofactors, so an exact Field divides once. Double 2x2 and 4x4 products
+// and the 4x4 transpose keep whole rows in SSE2 or AVX registers.
+namespace Small {
+
+const size_t kMaxSize = 4;
+
+template<size_t N, typename Field>
+Field Det(const Matrix<N, N, Field>& a);
+
+// Writes the adjugate (transposed cofactors) of a to adj and returns det(a), so that
+// a^-1 = adj / det whenever det != 0.
+template<size_t N, typename Field>
+Field Adjugate(const Matrix<N, N, Field>& a, Matrix<N, N, Field>& adj);
+
+template<size_t M, size_t N, size_t K, typename Field>
+Matrix<M, K, Field> Multiply(const Matrix<M, N, Field>& a, const Matrix<N, K, Field>& b);
+
+template<size_t M, size_t N, typename Field>
+Matrix<N, M, Field> Transpose(const Matrix<M, N, Field>& a);
+
+}
+
+#endif //SMALL_MATRIX_H_
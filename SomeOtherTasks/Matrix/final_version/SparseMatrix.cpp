@@ -0,0 +1,330 @@
+#pragma once
+
+#include "SparseMatrix.h"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+
+#include "DynMatrix.cpp"
+#include "Gauss.cpp"
+#include "Kernels.cpp"
+#include "ThreadPool.cpp"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Sparse matrix///////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+template<typename Field>
+SparseMatrix<Field>::SparseMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), row_starts_(rows + 1) {
+  CheckCols(cols);
+}
+
+template<typename Field>
+SparseMatrix<Field>::SparseMatrix(MatrixView<const Field> view) : rows_(view.rows()), cols_(view.cols()) {
+  CheckCols(cols_);
+  row_starts_.reserve(rows_ + 1);
+  for (size_t row = 0; row < rows_; ++row) {
+    for (size_t col = 0; col < cols_; ++col) {
+      if (view[row][col] != Field(0)) {
+        columns_.push_back(static_cast<Index>(col));
+        values_.push_back(view[row][col]);
+      }
+    }
+    row_starts_.push_back(values_.size());
+  }
+}
+
+template<typename Field>
+SparseMatrix<Field>::SparseMatrix(const DynMatrix<Field>& m) : SparseMatrix(m.view()) {}
+
+template<typename Field>
+template<size_t M, size_t N>
+SparseMatrix<Field>::SparseMatrix(const Matrix<M, N, Field>& m) : SparseMatrix(m.view()) {}
+
+template<typename Field>
+SparseMatrix<Field> SparseMatrix<Field>::identity(size_t n) {
+  SparseMatrix result(n, n);
+  result.columns_.resize(n);
+  result.values_.assign(n, Field(1));
+  for (size_t i = 0; i < n; ++i) {
+    result.columns_[i] = static_cast<Index>(i);
+    result.row_starts_[i + 1] = i + 1;
+  }
+  return result;
+}
+
+template<typename Field>
+void SparseMatrix<Field>::CheckCols(size_t cols) {
+  if (cols > UINT32_MAX) {
+    throw std::invalid_argument("SparseMatrix: at most 2^32 - 1 columns");
+  }
+}
+
+////////////////////////////////Access//////////////////////////////////////////////
+template<typename Field>
+std::span<const typename SparseMatrix<Field>::Index> SparseMatrix<Field>::columns(size_t row) const {
+  return {columns_.data() + row_starts_[row], row_starts_[row + 1] - row_starts_[row]};
+}
+
+template<typename Field>
+std::span<const Field> SparseMatrix<Field>::values(size_t row) const {
+  return {values_.data() + row_starts_[row], row_starts_[row + 1] - row_starts_[row]};
+}
+
+template<typename Field>
+Field SparseMatrix<Field>::at(size_t row, size_t col) const {
+  std::span<const Index> cols = columns(row);
+  auto it = std::lower_bound(cols.begin(), cols.end(), col);
+  if (it == cols.end() || *it != col) {
+    return Field(0);
+  }
+  return values(row)[it - cols.begin()];
+}
+
+////////////////////////////////Products////////////////////////////////////////////
+template<typename Field>
+size_t SparseMatrix<Field>::BlockStart(size_t part, size_t parts) const {
+  size_t target = (rows_ + nonzeros()) * part / parts;
+  auto rows = std::views::iota(size_t(0), rows_);
+  return *std::ranges::partition_point(rows, [&](size_t row) { return row + row_starts_[row] < target; });
+}
+
+template<typename Field>
+template<typename Body>
+void SparseMatrix<Field>::ForBlocks(ThreadPool* pool, size_t width, Body&& body) const {
+  size_t parts = pool == nullptr ? 1 : pool->size();
+  size_t work = (rows_ + nonzeros()) * width / parts;
+  Gauss::ForRows<Field>(pool, 0, parts, work, [&](size_t lo, size_t hi) {
+    body(BlockStart(lo, parts), hi == parts ? rows_ : BlockStart(hi, parts));
+  });
+}
+
+template<typename Field>
+std::vector<Field> SparseMatrix<Field>::apply(std::span<const Field> x, ThreadPool* pool) const {
+  if (x.size() != cols_) {
+    throw std::invalid_argument("SparseMatrix: vector size does not match");
+  }
+  std::vector<Field> result(rows_);
+  ForBlocks(pool, 1, [&](size_t lo, size_t hi) {
+    for (size_t row = lo; row < hi; ++row) {
+      Field sum = 0;
+      for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+        sum += values_[idx] * x[columns_[idx]];
+      }
+      result[row] = sum;
+    }
+  });
+  return result;
+}
+
+template<typename Field>
+std::vector<Field> SparseMatrix<Field>::applyTransposed(std::span<const Field> x) const {
+  if (x.size() != rows_) {
+    throw std::invalid_argument("SparseMatrix: vector size does not match");
+  }
+  std::vector<Field> result(cols_);
+  for (size_t row = 0; row < rows_; ++row) {
+    for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+      result[columns_[idx]] += values_[idx] * x[row];
+    }
+  }
+  return result;
+}
+
+template<typename Field>
+DynMatrix<Field> SparseMatrix<Field>::multiply(const DynMatrix<Field>& b, ThreadPool* pool) const {
+  if (b.rows() != cols_) {
+    throw std::invalid_argument("SparseMatrix: shapes do not match");
+  }
+  DynMatrix<Field> result(rows_, b.cols());
+  ForBlocks(pool, b.cols(), [&](size_t lo, size_t hi) {
+    for (size_t row = lo; row < hi; ++row) {
+      for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+        Kernels::AddScaled(result[row].data(), b[columns_[idx]].data(), values_[idx], b.cols());
+      }
+    }
+  });
+  return result;
+}
+
+// Scattering the rows in order leaves every column of the result sorted by row.
+template<typename Field>
+SparseMatrix<Field> SparseMatrix<Field>::transposed() const {
+  SparseMatrix result(cols_, rows_);
+  for (Index col : columns_) {
+    ++result.row_starts_[col + 1];
+  }
+  for (size_t col = 0; col < cols_; ++col) {
+    result.row_starts_[col + 1] += result.row_starts_[col];
+  }
+  result.columns_.resize(nonzeros());
+  result.values_.resize(nonzeros());
+  std::vector<size_t> next(result.row_starts_.begin(), result.row_starts_.end() - 1);
+  for (size_t row = 0; row < rows_; ++row) {
+    for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+      size_t pos = next[columns_[idx]]++;
+      result.columns_[pos] = static_cast<Index>(row);
+      result.values_[pos] = values_[idx];
+    }
+  }
+  return result;
+}
+
+////////////////////////////////Conversions/////////////////////////////////////////
+template<typename Field>
+DynMatrix<Field> SparseMatrix<Field>::toDynMatrix() const {
+  DynMatrix<Field> result(rows_, cols_);
+  for (size_t row = 0; row < rows_; ++row) {
+    for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+      result[row][columns_[idx]] = values_[idx];
+    }
+  }
+  return result;
+}
+
+template<typename Field>
+template<size_t M, size_t N>
+Matrix<M, N, Field> SparseMatrix<Field>::toMatrix() const {
+  if (rows_ != M || cols_ != N) {
+    throw std::invalid_argument("SparseMatrix: shapes do not match");
+  }
+  Matrix<M, N, Field> result;
+  for (size_t row = 0; row < rows_; ++row) {
+    for (size_t idx = row_starts_[row]; idx < row_starts_[row + 1]; ++idx) {
+      result[row][columns_[idx]] = values_[idx];
+    }
+  }
+  return result;
+}
+
+////////////////////////////////Operators///////////////////////////////////////////
+template<typename Field>
+std::vector<Field> operator*(const SparseMatrix<Field>& a, std::span<const Field> x) {
+  return a.apply(x);
+}
+
+template<typename Field>
+DynMatrix<Field> operator*(const SparseMatrix<Field>& a, const DynMatrix<Field>& b) {
+  return a.multiply(b);
+}
+
+// Both sides are sorted and free of zeros, so equal matrices store the same arrays.
+template<typename Field>
+bool operator==(const SparseMatrix<Field>& m1, const SparseMatrix<Field>& m2) {
+  if (m1.rows() != m2.rows() || m1.cols() != m2.cols() || m1.nonzeros() != m2.nonzeros()) {
+    return false;
+  }
+  for (size_t row = 0; row < m1.rows(); ++row) {
+    if (!std::ranges::equal(m1.columns(row), m2.columns(row)) || !std::ranges::equal(m1.values(row), m2.values(row))) {
+      return false;
+    }
+  }
+  return true;
+}
+template<typename Field>
+bool operator!=(const SparseMatrix<Field>& m1, const SparseMatrix<Field>& m2) {
+  return !(m1 == m2);
+}
+
+template<typename Field>
+std::ostream& operator<<(std::ostream& out, const SparseMatrix<Field>& m) {
+  for (size_t row = 0; row < m.rows(); ++row) {
+    std::span<const typename SparseMatrix<Field>::Index> cols = m.columns(row);
+    std::span<const Field> values = m.values(row);
+    for (size_t idx = 0; idx < cols.size(); ++idx) {
+      out << row << " " << cols[idx] << " " << values[idx] << "\n";
+    }
+  }
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Sparse builder//////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+template<typename Field>
+SparseBuilder<Field>::SparseBuilder(size_t rows, size_t cols) : rows_(rows), cols_(cols) {
+  SparseMatrix<Field>::CheckCols(cols);
+}
+
+template<typename Field>
+void SparseBuilder<Field>::reserve(size_t triplets) {
+  rows_of_.reserve(triplets);
+  columns_.reserve(triplets);
+  values_.reserve(triplets);
+}
+
+template<typename Field>
+void SparseBuilder<Field>::add(size_t row, size_t col, const Field& value) {
+  if (row >= rows_ || col >= cols_) {
+    throw std::out_of_range("SparseBuilder: position outside the matrix");
+  }
+  rows_of_.push_back(row);
+  columns_.push_back(static_cast<Index>(col));
+  values_.push_back(value);
+}
+
+// Orders the triplets by column, then scatters them stably into their rows, so every
+// row comes out sorted by column and repeated positions are adjacent to be summed.
+template<typename Field>
+SparseMatrix<Field> SparseBuilder<Field>::build() {
+  size_t count = values_.size();
+  std::vector<size_t> col_starts(cols_ + 1);
+  for (Index col : columns_) {
+    ++col_starts[col + 1];
+  }
+  for (size_t col = 0; col < cols_; ++col) {
+    col_starts[col + 1] += col_starts[col];
+  }
+  std::vector<size_t> by_column(count);
+  for (size_t idx = 0; idx < count; ++idx) {
+    by_column[col_starts[columns_[idx]]++] = idx;
+  }
+  col_starts = {};
+
+  SparseMatrix<Field> result(rows_, cols_);
+  std::vector<size_t>& starts = result.row_starts_;
+  for (size_t row : rows_of_) {
+    ++starts[row + 1];
+  }
+  for (size_t row = 0; row < rows_; ++row) {
+    starts[row + 1] += starts[row];
+  }
+  result.columns_.resize(count);
+  result.values_.resize(count);
+  std::vector<size_t> next(starts.begin(), starts.end() - 1);
+  for (size_t idx : by_column) {
+    size_t pos = next[rows_of_[idx]]++;
+    result.columns_[pos] = columns_[idx];
+    result.values_[pos] = std::move(values_[idx]);
+  }
+  by_column = {};
+  rows_of_ = {};
+  columns_ = {};
+  values_ = {};
+
+  size_t size = 0;
+  for (size_t row = 0, idx = 0; row < rows_; ++row) {
+    size_t end = starts[row + 1];
+    while (idx < end) {
+      Index col = result.columns_[idx];
+      Field sum = std::move(result.values_[idx]);
+      for (++idx; idx < end && result.columns_[idx] == col; ++idx) {
+        sum += result.values_[idx];
+      }
+      if (sum != Field(0)) {
+        result.columns_[size] = col;
+        result.values_[size] = std::move(sum);
+        ++size;
+      }
+    }
+    starts[row + 1] = size;
+  }
+  result.columns_.resize(size);
+  result.values_.resize(size);
+  result.columns_.shrink_to_fit();
+  result.values_.shrink_to_fit();
+  return result;
+}
@@ -0,0 +1,137 @@
+#ifndef SPARSE_MATRIX_H_
+#define SPARSE_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <vector>
+
+#include "DynMatrix.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Sparse matrix///////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+template<typename Field>
+class SparseBuilder;
+
+// Compressed sparse rows: the nonzeros of every row sorted by column, rows back to
+// back, and where each row starts. Memory is O(rows + nonzeros) at 4 bytes of index
+// per nonzero, so a 10^6 x 10^6 double matrix with 10^7 nonzeros takes about 120 MB.
+// Built from triplets with SparseBuilder or from a dense matrix, dropping its zeros.
+template<typename Field = int64_t>
+class SparseMatrix {
+ public:
+  using Index = uint32_t;
+  using value_type = Field;
+
+  SparseMatrix() = default;
+  // Zero matrix; throws std::invalid_argument unless cols < 2^32.
+  SparseMatrix(size_t rows, size_t cols);
+  explicit SparseMatrix(MatrixView<const Field>);
+  explicit SparseMatrix(const DynMatrix<Field>&);
+  template<size_t M, size_t N>
+  explicit SparseMatrix(const Matrix<M, N, Field>&);
+
+  static SparseMatrix identity(size_t n);
+
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t nonzeros() const { return values_.size(); }
+
+  // Columns of the nonzeros of a row, ascending, and their values.
+  std::span<const Index> columns(size_t row) const;
+  std::span<const Field> values(size_t row) const;
+  // Element at (row, col), zero when it is not stored; O(log nonzeros of the row).
+  Field at(size_t row, size_t col) const;
+
+  // A x in O(rows + nonzeros). Given a pool, rows are split into blocks of equal
+  // nonzero count, so a few dense rows do not keep one thread busy alone.
+  // Throws std::invalid_argument unless x.size() == cols().
+  std::vector<Field> apply(std::span<const Field> x, ThreadPool* pool = nullptr) const;
+  // A^T x in O(cols + nonzeros), on the calling thread: the rows of A scatter into
+  // the result, so splitting them would race. Throws std::invalid_argument unless
+  // x.size() == rows().
+  std::vector<Field> applyTransposed(std::span<const Field> x) const;
+
+  // A B in O(nonzeros * B.cols()), every nonzero adding a scaled row of B.
+  // Throws std::invalid_argument unless B.rows() == cols().
+  DynMatrix<Field> multiply(const DynMatrix<Field>& b, ThreadPool* pool = nullptr) const;
+
+  SparseMatrix transposed() const;
+
+  DynMatrix<Field> toDynMatrix() const;
+  // Throws std::invalid_argument unless the matrix is M x N.
+  template<size_t M, size_t N>
+  Matrix<M, N, Field> toMatrix() const;
+
+ private:
+  friend class SparseBuilder<Field>;
+
+  static void CheckCols(size_t cols);
+  // First row of block part out of parts, counting a row as one plus its nonzeros.
+  size_t BlockStart(size_t part, size_t parts) const;
+  // Runs body(lo, hi) over row blocks of about equal work, in parallel given a pool.
+  template<typename Body>
+  void ForBlocks(ThreadPool* pool, size_t width, Body&& body) const;
+
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  // Row i owns the nonzeros [row_starts_[i], row_starts_[i + 1]).
+  std::vector<size_t> row_starts_ = {0};
+  std::vector<Index> columns_;
+  std::vector<Field> values_;
+};
+
+template<typename Field>
+std::vector<Field> operator*(const SparseMatrix<Field>&, std::span<const Field>);
+
+template<typename Field>
+DynMatrix<Field> operator*(const SparseMatrix<Field>&, const DynMatrix<Field>&);
+
+template<typename Field>
+bool operator==(const SparseMatrix<Field>&, const SparseMatrix<Field>&);
+
+template<typename Field>
+bool operator!=(const SparseMatrix<Field>&, const SparseMatrix<Field>&);
+
+// One "row col value" line per nonzero.
+template<typename Field>
+std::ostream& operator<<(std::ostream&, const SparseMatrix<Field>&);
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Sparse builder//////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Collects (row, col, value) triplets in any order, then sorts them into a
+// SparseMatrix in O(rows + cols + triplets) with two counting passes. Triplets at
+// the same position are summed and entries that end up zero are dropped.
+template<typename Field = int64_t>
+class SparseBuilder {
+ public:
+  // Throws std::invalid_argument unless cols < 2^32.
+  SparseBuilder(size_t rows, size_t cols);
+
+  void reserve(size_t triplets);
+  // Throws std::out_of_range when (row, col) lies outside the matrix.
+  void add(size_t row, size_t col, const Field& value);
+  size_t size() const { return values_.size(); }
+
+  // Leaves the builder empty, ready for the next matrix of the same shape.
+  SparseMatrix<Field> build();
+
+ private:
+  using Index = typename SparseMatrix<Field>::Index;
+
+  size_t rows_;
+  size_t cols_;
+  std::vector<size_t> rows_of_;
+  std::vector<Index> columns_;
+  std::vector<Field> values_;
+};
+
+#endif //SPARSE_MATRIX_H_
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+inline ThreadPool::ThreadPool(size_t threads) {
+  for (size_t i = 1; i < std::max<size_t>(threads, 1); ++i) {
+    workers_.emplace_back(&ThreadPool::Work, this, i);
+  }
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+template<typename Body>
+void ThreadPool::ParallelFor(size_t begin, size_t end, Body&& body) {
+  if (begin >= end) {
+    return;
+  }
+  size_t block = (end - begin + size() - 1) / size();
+  if (workers_.empty() || block == end - begin) {
+    body(begin, end);
+    return;
+  }
+  Run([&](size_t index) {
+    size_t lo = begin + std::min(end - begin, index * block);
+    size_t hi = std::min(end, lo + block);
+    if (lo < hi) {
+      body(lo, hi);
+    }
+  });
+}
+
+// Publishes the task as a new generation, takes share 0 itself and waits for the rest.
+inline void ThreadPool::Run(const std::function<void(size_t)>& task) {
+  {
+    std::lock_guard lock(mutex_);
+    task_ = &task;
+    error_ = nullptr;
+    pending_ = workers_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+  {
+    // The workers hold a pointer to task, so even if share 0 throws, wait for them.
+    struct Join {
+      ThreadPool& pool;
+      ~Join() {
+        std::unique_lock lock(pool.mutex_);
+        pool.done_.wait(lock, [this] { return pool.pending_ == 0; });
+        pool.task_ = nullptr;
+      }
+    } join{*this};
+    task(0);
+  }
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+inline void ThreadPool::Work(size_t index) {
+  size_t seen = 0;
+  while (true) {
+    const std::function<void(size_t)>* task = nullptr;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      task = task_;
+    }
+    std::exception_ptr error;
+    try {
+      (*task)(index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard lock(mutex_);
+    if (error && !error_) {
+      error_ = error;
+    }
+    if (--pending_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
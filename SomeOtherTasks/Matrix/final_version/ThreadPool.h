@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Thread pool/////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Fixed set of workers for fork-join loops: the calling thread takes a share of
+// every loop and returns only when all shares are done.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // Number of threads sharing a loop, the caller included.
+  size_t size() const { return workers_.size() + 1; }
+
+  // Splits [begin, end) into size() contiguous blocks and runs body(lo, hi) on each.
+  // If a block throws, the first exception is rethrown here once all blocks are done.
+  template<typename Body>
+  void ParallelFor(size_t begin, size_t end, Body&& body);
+
+ private:
+  void Run(const std::function<void(size_t)>& task);
+  void Work(size_t index);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)>* task_ = nullptr;
+  std::exception_ptr error_;
+  size_t generation_ = 0;
+  size_t pending_ = 0;
+  bool stop_ = false;
+};
+
+#endif //THREAD_POOL_H_
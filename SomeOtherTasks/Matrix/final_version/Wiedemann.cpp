@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Wiedemann.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Gauss.cpp"
+#include "ThreadPool.cpp"
+
+namespace Wiedemann {
+
+// Det retries with fresh randomness up to this many times before giving up.
+const size_t kDetAttempts = 16;
+// Rank keeps the largest of up to this many independent estimates, stopping early
+// when one repeats the largest so far.
+const size_t kRankTrials = 3;
+const uint64_t kSeed = 0x5eed;
+
+template<typename Field>
+std::vector<Field> MinimalPolynomial(std::span<const Field> sequence) {
+  // Massey's connection polynomial c, with c[0] = 1 and sum c[i] s[k - i] = 0 for
+  // every k from length on; prev is c as it was before length last grew.
+  std::vector<Field> c = {Field(1)};
+  std::vector<Field> prev = {Field(1)};
+  Field prev_discrepancy = 1;
+  size_t length = 0;
+  size_t shift = 1;
+  for (size_t k = 0; k < sequence.size(); ++k) {
+    Field discrepancy = sequence[k];
+    for (size_t i = 1; i <= length && i < c.size(); ++i) {
+      discrepancy += c[i] * sequence[k - i];
+    }
+    if (discrepancy == Field(0)) {
+      ++shift;
+      continue;
+    }
+    Field koef = discrepancy / prev_discrepancy;
+    std::vector<Field> old_c = c;
+    c.resize(std::max(c.size(), prev.size() + shift), Field(0));
+    for (size_t i = 0; i < prev.size(); ++i) {
+      c[i + shift] -= koef * prev[i];
+    }
+    if (2 * length <= k) {
+      length = k + 1 - length;
+      prev = std::move(old_c);
+      prev_discrepancy = discrepancy;
+      shift = 1;
+    } else {
+      ++shift;
+    }
+  }
+  c.resize(length + 1, Field(0));
+  // The reversal x^length c(1/x) is the generator.
+  std::reverse(c.begin(), c.end());
+  return c;
+}
+
+template<typename Field>
+std::vector<Field> RandomVector(std::mt19937_64& rng, size_t size, bool nonzero) {
+  std::vector<Field> result(size);
+  for (Field& value : result) {
+    do {
+      value = Field(static_cast<int>(rng() >> 33));
+    } while (nonzero && value == Field(0));
+  }
+  return result;
+}
+
+template<typename Field>
+void ScaleBy(std::vector<Field>& values, const std::vector<Field>& diagonal) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] *= diagonal[i];
+  }
+}
+
+template<typename BlackBox, typename Field>
+std::vector<Field> Apply(const BlackBox& a, const std::vector<Field>& x, ThreadPool* pool) {
+  if constexpr (requires { a.apply(std::span<const Field>(x), pool); }) {
+    return a.apply(std::span<const Field>(x), pool);
+  } else {
+    return a.apply(std::span<const Field>(x));
+  }
+}
+
+template<typename BlackBox, typename Field>
+std::vector<Field> ApplyTransposed(const BlackBox& a, const std::vector<Field>& x, ThreadPool* pool) {
+  if constexpr (requires { a.applyTransposed(std::span<const Field>(x), pool); }) {
+    return a.applyTransposed(std::span<const Field>(x), pool);
+  } else {
+    return a.applyTransposed(std::span<const Field>(x));
+  }
+}
+
+// u^T B^i v for i < count, where step turns a vector into its product with B.
+template<typename Field, typename Step>
+std::vector<Field> Project(const std::vector<Field>& u, std::vector<Field> v, size_t count, Step&& step) {
+  std::vector<Field> sequence;
+  sequence.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (i != 0) {
+      step(v);
+    }
+    Field dot = 0;
+    for (size_t j = 0; j < u.size(); ++j) {
+      dot += u[j] * v[j];
+    }
+    sequence.push_back(dot);
+  }
+  return sequence;
+}
+
+// A D for a random nonsingular diagonal D has, with high probability, a minimal
+// polynomial equal to its characteristic one (Kaltofen-Pan), whose constant term is
+// (-1)^n det(A D). Both outcomes are certain once reached: a generator of degree n
+// is the characteristic polynomial, and one divisible by x makes A D singular.
+template<typename BlackBox>
+typename BlackBox::value_type Det(const BlackBox& a, ThreadPool* pool) {
+  using Field = typename BlackBox::value_type;
+  static_assert(!std::is_floating_point_v<Field> && !Gauss::IsIntegralField<Field>::value,
+                "Wiedemann needs an exact field");
+  size_t n = a.rows();
+  if (a.cols() != n) {
+    throw std::invalid_argument("Wiedemann: matrix is not square");
+  }
+  if (n == 0) {
+    return Field(1);
+  }
+  std::mt19937_64 rng(kSeed);
+  for (size_t attempt = 0; attempt < kDetAttempts; ++attempt) {
+    std::vector<Field> diagonal = RandomVector<Field>(rng, n, true);
+    std::vector<Field> u = RandomVector<Field>(rng, n, false);
+    std::vector<Field> v = RandomVector<Field>(rng, n, false);
+    std::vector<Field> sequence = Project(u, std::move(v), 2 * n, [&](std::vector<Field>& x) {
+      ScaleBy(x, diagonal);
+      x = Apply(a, x, pool);
+    });
+    std::vector<Field> poly = MinimalPolynomial<Field>(sequence);
+    if (poly.front() == Field(0)) {
+      return Field(0);
+    }
+    if (poly.size() == n + 1) {
+      Field scale = 1;
+      for (const Field& value : diagonal) {
+        scale *= value;
+      }
+      Field det = n % 2 == 0 ? poly.front() : Field(0) - poly.front();
+      return det / scale;
+    }
+  }
+  throw std::domain_error("Wiedemann: field too small for the matrix");
+}
+
+// B = D1 A^T D2 A D1 with random diagonals has the rank of A, and symmetric B scaled
+// that way has a minimal polynomial without repeated factor x (Eberly-Kaltofen), so
+// its degree is the rank, plus one when B is singular. A projection can only lose
+// factors, which is why the estimates never exceed the rank and the largest is kept.
+template<typename BlackBox>
+size_t Rank(const BlackBox& a, ThreadPool* pool) {
+  using Field = typename BlackBox::value_type;
+  static_assert(!std::is_floating_point_v<Field> && !Gauss::IsIntegralField<Field>::value,
+                "Wiedemann needs an exact field");
+  size_t n = a.cols();
+  size_t full = std::min(a.rows(), n);
+  size_t rank = 0;
+  std::mt19937_64 rng(kSeed);
+  for (size_t trial = 0; trial < kRankTrials && rank < full; ++trial) {
+    std::vector<Field> right = RandomVector<Field>(rng, n, true);
+    std::vector<Field> left = RandomVector<Field>(rng, a.rows(), true);
+    std::vector<Field> u = RandomVector<Field>(rng, n, false);
+    std::vector<Field> v = RandomVector<Field>(rng, n, false);
+    std::vector<Field> sequence = Project(u, std::move(v), 2 * n, [&](std::vector<Field>& x) {
+      ScaleBy(x, right);
+      std::vector<Field> y = Apply(a, x, pool);
+      ScaleBy(y, left);
+      x = ApplyTransposed(a, y, pool);
+      ScaleBy(x, right);
+    });
+    std::vector<Field> poly = MinimalPolynomial<Field>(sequence);
+    size_t degree = poly.size() - 1;
+    size_t estimate = poly.front() == Field(0) ? degree - 1 : degree;
+    if (trial != 0 && estimate == rank) {
+      break;
+    }
+    rank = std::max(rank, estimate);
+  }
+  return rank;
+}
+
+}
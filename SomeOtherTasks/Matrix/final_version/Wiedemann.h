@@ -0,0 +1,44 @@
+#ifndef WIEDEMANN_H_
+#define WIEDEMANN_H_
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "ThreadPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////Wiedemann///////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+// Determinant and rank of a matrix known only as a black box x -> A x, for matrices
+// far too large for elimination, e.g. a SparseMatrix over a prime field. Both project
+// the 2n terms u^T B^i v of a randomly preconditioned B onto scalars, recover their
+// minimal polynomial with Berlekamp-Massey and read the answer off it: 2n products
+// and O(n^2) field operations, so O(n * nonzeros) for a sparse A, in O(n) memory.
+//
+// BlackBox has value_type, rows(), cols() and apply(std::span<const value_type>)
+// returning std::vector<value_type>; Rank also needs applyTransposed for A^T x.
+// When apply takes a ThreadPool* after the vector, the pool is passed on.
+// value_type must be a finite field with exact division (Residue<p>, FastResidue<p>,
+// DynResidue in a prime ModulusScope) and much larger than n: a random choice fails
+// with probability about n / p, which Det retries and Rank repeats against.
+namespace Wiedemann {
+
+// Monic minimal polynomial of the linearly recurrent sequence, coefficients from the
+// constant term up; its degree is at most half the length of the sequence.
+template<typename Field>
+std::vector<Field> MinimalPolynomial(std::span<const Field> sequence);
+
+// Throws std::invalid_argument unless a is square, and std::domain_error when every
+// attempt is unlucky, which only happens when the field is too small for n.
+template<typename BlackBox>
+typename BlackBox::value_type Det(const BlackBox& a, ThreadPool* pool = nullptr);
+
+// Monte Carlo: never above the rank and equal to it with high probability.
+template<typename BlackBox>
+size_t Rank(const BlackBox& a, ThreadPool* pool = nullptr);
+
+}
+
+#endif //WIEDEMANN_H_
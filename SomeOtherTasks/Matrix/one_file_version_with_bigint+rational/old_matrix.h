@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 class BigInteger {
@@ -185,6 +187,9 @@ void BigInteger::Substract(const BigInteger& b) {
 }
 
 void BigInteger::Divide(BigInteger b, bool div = true) {
+  if (integer_.empty()) {
+    return;
+  }
   Sign save_sign = sign_;
   if (b.sign_ == Sign::Minus) {
     b.sign_ = Sign::Plus;
@@ -502,8 +507,9 @@ class Rational {
   BigInteger numerator_;
   BigInteger denominator_;
   void MakeSimple(bool);
-  static BigInteger GCD(BigInteger, BigInteger);
  public:
+  static BigInteger GCD(BigInteger, BigInteger);
+
   Rational() : numerator_(0), denominator_(1) {}
   Rational(int64_t, int64_t);
   Rational(const BigInteger&, const BigInteger&);
@@ -520,6 +526,9 @@ class Rational {
   std::string asDecimal(std::size_t);
 
   Rational abs() const { return {numerator_, denominator_}; }
+  // Signed numerator and positive denominator of the reduced fraction.
+  BigInteger numerator() const { return static_cast<int>(sign_) * numerator_; }
+  const BigInteger& denominator() const { return denominator_; }
 
   explicit operator double();
   friend bool operator<(const Rational& a, const Rational& b);
@@ -775,18 +784,24 @@ class Residue {
     }
     return *this;
   }
+  // Extended Euclid, O(log N); number must be coprime to N.
+  Residue inverse() const {
+    int64_t remainder = number;
+    int64_t next_remainder = N;
+    int64_t coef = 1;
+    int64_t next_coef = 0;
+    while (next_remainder != 0) {
+      int64_t quotient = remainder / next_remainder;
+      remainder = std::exchange(next_remainder, remainder - quotient * next_remainder);
+      coef = std::exchange(next_coef, coef - quotient * next_coef);
+    }
+    Residue result;
+    result.number = coef < 0 ? coef + N : coef;
+    return result;
+  }
   Residue& operator/=(const Residue<N>& r) {
     static_assert(Simple);
-    if (number >= N) {
-      number %= N;
-    }
-    for (int64_t i = 1;; ++i) {
-      if ((r.number * i) % N == number) {
-        number = i;
-        break;
-      }
-    }
-    return *this;
+    return *this *= r.inverse();
   }
   Residue& operator*=(const Residue<N>& r) {
     number *= r.number;
@@ -936,8 +951,33 @@ class Matrix {
 
   ////////////////////////////////////////////////////////////////////////////////
 
+  // Over Rational and integer fields both go fraction-free (Bareiss): rows are
+  // cleared of denominators first, so no step pays for a Rational division and
+  // every intermediate is a minor of the integer matrix.
   Field det() const {
     static_assert(N == M);
+    if constexpr (std::is_same_v<Field, Rational>) {
+      BigInteger scale = 1;
+      return Rational(BareissDet(ClearDenominators(scale)), scale);
+    } else if constexpr (kIntegral) {
+      return BareissDet(matrix);
+    } else {
+      return GaussDet();
+    }
+  }
+
+  size_t rank() const {
+    if constexpr (std::is_same_v<Field, Rational>) {
+      BigInteger scale = 1;
+      return BareissRank(ClearDenominators(scale));
+    } else if constexpr (kIntegral) {
+      return BareissRank(matrix);
+    } else {
+      return GaussRank();
+    }
+  }
+
+  Field GaussDet() const {
     Matrix copy = *this;
     Field det = 1;
     for (size_t cnt = 0; cnt < N; ++cnt) {
@@ -957,9 +997,10 @@ class Matrix {
         std::swap(copy.matrix[cnt], copy.matrix[max_idx]);
       }
       det *= copy.matrix[cnt][cnt];
+      Field inverse = Field(1) / copy.matrix[cnt][cnt];
       Field koef = 0;
       for (size_t row = cnt + 1; row < N; ++row) {
-        koef = copy.matrix[row][cnt] / copy.matrix[cnt][cnt];
+        koef = copy.matrix[row][cnt] * inverse;
         for (size_t col = cnt; col < N; ++col) {
           copy.matrix[row][col] -= koef * copy.matrix[cnt][col];
         }
@@ -968,7 +1009,7 @@ class Matrix {
     return det;
   }
 
-  size_t rank() const {
+  size_t GaussRank() const {
     Matrix m = *this;
     size_t row = 0;
     size_t col = 0;
@@ -989,14 +1030,15 @@ class Matrix {
           std::swap(m.matrix[row][i], m.matrix[idx][i]);
         }
       }
-      Field k = m.matrix[row][col];
+      Field inverse = Field(1) / m.matrix[row][col];
       m.matrix[row][col] = Field(1);
       for (size_t i = col + 1; i < N; ++i) {
-        m.matrix[row][i] /= k;
+        m.matrix[row][i] *= inverse;
       }
+      // The pivot is 1 now, so the multiplier is the entry itself.
       for (size_t other_row = row + 1; other_row < M; ++other_row) {
         if (!(m.matrix[other_row][col] == Field(0))) {
-          Field koef = m.matrix[other_row][col] / m.matrix[col][col];
+          Field koef = m.matrix[other_row][col];
           for (size_t i = 0; i < N; ++i) {
             m.matrix[other_row][i] -= (m.matrix[row][i] * koef);
           }
@@ -1081,6 +1123,90 @@ class Matrix {
   }
 
  private:
+  static constexpr bool kIntegral = std::is_integral_v<Field> || std::is_same_v<Field, BigInteger>;
+
+  // Scales row i by the lcm l_i of its denominators; scale collects the product
+  // of all l_i, so det() = det(result) / scale and rank() = rank(result).
+  std::array<std::array<BigInteger, N>, M> ClearDenominators(BigInteger& scale) const {
+    std::array<std::array<BigInteger, N>, M> result;
+    for (size_t row = 0; row < M; ++row) {
+      BigInteger lcm = 1;
+      for (size_t col = 0; col < N; ++col) {
+        const BigInteger& den = matrix[row][col].denominator();
+        if (den != 1) {
+          lcm = lcm / Rational::GCD(lcm, den) * den;
+        }
+      }
+      for (size_t col = 0; col < N; ++col) {
+        result[row][col] = matrix[row][col].numerator() * (lcm / matrix[row][col].denominator());
+      }
+      scale *= lcm;
+    }
+    return result;
+  }
+
+  // (a * b - c * d) / e, exact by construction; built-in integers go through
+  // __int128 since the products may overflow even when the minors fit.
+  template<typename Int>
+  static Int BareissStep(const Int& a, const Int& b, const Int& c, const Int& d, const Int& e) {
+    if constexpr (std::is_integral_v<Int>) {
+      return static_cast<Int>((__int128(a) * b - __int128(c) * d) / e);
+    } else {
+      return (a * b - c * d) / e;
+    }
+  }
+
+  // After step k every entry below the pivots is a (k + 1)-minor of the input.
+  template<typename Int>
+  static Int BareissDet(std::array<std::array<Int, N>, M> a) {
+    Int prev = 1;
+    bool negate = false;
+    for (size_t k = 0; k < N; ++k) {
+      if (a[k][k] == Int(0)) {
+        size_t idx = k + 1;
+        while (idx < N && a[idx][k] == Int(0)) {
+          ++idx;
+        }
+        if (idx == N) {
+          return 0;
+        }
+        std::swap(a[k], a[idx]);
+        negate = !negate;
+      }
+      for (size_t row = k + 1; row < N; ++row) {
+        for (size_t col = k + 1; col < N; ++col) {
+          a[row][col] = BareissStep(a[row][col], a[k][k], a[row][k], a[k][col], prev);
+        }
+      }
+      prev = a[k][k];
+    }
+    return negate ? Int(0) - a[N - 1][N - 1] : a[N - 1][N - 1];
+  }
+
+  template<typename Int>
+  static size_t BareissRank(std::array<std::array<Int, N>, M> a) {
+    Int prev = 1;
+    size_t row = 0;
+    for (size_t col = 0; col < N && row < M; ++col) {
+      size_t idx = row;
+      while (idx < M && a[idx][col] == Int(0)) {
+        ++idx;
+      }
+      if (idx == M) {
+        continue;
+      }
+      std::swap(a[row], a[idx]);
+      for (size_t other_row = row + 1; other_row < M; ++other_row) {
+        for (size_t i = col + 1; i < N; ++i) {
+          a[other_row][i] = BareissStep(a[other_row][i], a[row][col], a[other_row][col], a[row][i], prev);
+        }
+      }
+      prev = a[row][col];
+      ++row;
+    }
+    return row;
+  }
+
   void GaussInvert(Matrix<M, N, Field>&);
   std::array<std::array<Field, N>, M> matrix;
 };
@@ -1122,13 +1248,14 @@ Matrix<M, N, Field> operator*(const Residue<K>& r, Matrix<M, N, Field> m) {
 template<size_t M, size_t N, typename Field>
 void Matrix<M, N, Field>::GaussInvert(Matrix<M, N, Field>& E) {
   for (size_t cnt = 0; cnt < M; ++cnt) {
+    Field inverse = Field(1) / matrix[cnt][cnt];
     for (size_t other_row = 0; other_row < M; ++other_row) {
       if (other_row == cnt) {
         continue;
       }
       Field koef = 0;
       if (!(matrix[other_row][cnt] == Field(0))) {
-        koef = matrix[other_row][cnt] / matrix[cnt][cnt];
+        koef = matrix[other_row][cnt] * inverse;
         for (size_t col = 0; col < M; ++col) {
           if (col >= cnt) {
             matrix[other_row][col] -= matrix[cnt][col] * koef;
@@ -1139,8 +1266,9 @@ void Matrix<M, N, Field>::GaussInvert(Matrix<M, N, Field>& E) {
     }
   }
   for (size_t row = 0; row < N; ++row) {
+    Field inverse = Field(1) / matrix[row][row];
     for (size_t col = 0; col < N; ++col) {
-      E.matrix[row][col] /= matrix[row][row];
+      E.matrix[row][col] *= inverse;
     }
   }
   *this = E;